@@ -0,0 +1,360 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <Sol2dTexturePackerBench/Benchmark.h>
+#include <LibSol2dTexturePacker/Packers/MaxRectsBinAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/SkylineBinAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/GuillotineBinAtlaskPacker.h>
+#include <LibSol2dTexturePacker/Packers/ShelfBinAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/MetaAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/AnnealingAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/BranchAndBoundAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Atlas/Sol2dAtlasSerializer.h>
+#include <LibSol2dTexturePacker/Pack/AtlasPack.h>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QSet>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const char * g_atlas_name = "bench";
+const char * g_texture_format = "png";
+// Keeps the search short enough to be measured repeatedly
+constexpr qint64 g_annealing_iteration_limit = 200;
+// The exhaustive search is meant for small UI atlases
+constexpr qsizetype g_exact_sprite_limit = 40;
+
+double toMilliseconds(qint64 _ns)
+{
+    return static_cast<double>(_ns) / 1000000.0;
+}
+
+qint64 calculateSpriteArea(const QList<Sprite> & _sprites)
+{
+    qint64 area = 0;
+    for(const Sprite & sprite : _sprites)
+        area += static_cast<qint64>(sprite.image.width()) * sprite.image.height();
+    return area;
+}
+
+QJsonObject describePack(const RawAtlasPack & _pack)
+{
+    qint64 atlas_area = 0;
+    qint64 used_area = 0;
+    for(const RawAtlas & atlas : _pack)
+    {
+        atlas_area += static_cast<qint64>(atlas.image.width()) * atlas.image.height();
+        QSet<quint64> placed;
+        for(const Frame & frame : atlas.frames)
+        {
+            const quint64 key = (static_cast<quint64>(frame.texture_rect.x()) << 32) |
+                static_cast<quint32>(frame.texture_rect.y());
+            if(placed.contains(key))
+                continue;
+            placed.insert(key);
+            used_area += static_cast<qint64>(frame.texture_rect.width()) * frame.texture_rect.height();
+        }
+    }
+    return QJsonObject
+    {
+        { "atlases", static_cast<qint64>(_pack.count()) },
+        { "atlas_area", atlas_area },
+        { "occupancy", atlas_area == 0 ? 0.0 : static_cast<double>(used_area) / static_cast<double>(atlas_area) }
+    };
+}
+
+} // namespace
+
+Benchmark::Benchmark(const BenchmarkOptions & _options, QTextStream & _out, QTextStream & _log) :
+    m_options(_options),
+    m_out(_out),
+    m_log(_log)
+{
+    const qsizetype unlimited = std::numeric_limits<qsizetype>::max();
+    m_packers =
+    {
+        { "maxrects", []() { return new MaxRectsBinAtlasPacker(); }, unlimited },
+        {
+            "maxrects-rbp",
+            []() {
+                MaxRectsBinAtlasPacker * packer = new MaxRectsBinAtlasPacker();
+                packer->setEngine(OnlineAlgorithmEngine::RectangleBinPack);
+                return packer;
+            },
+            unlimited
+        },
+        {
+            "maxrects-partitioned",
+            []() {
+                MaxRectsBinAtlasPacker * packer = new MaxRectsBinAtlasPacker();
+                packer->setPartitionCount(0);
+                return packer;
+            },
+            unlimited
+        },
+        { "skyline", []() { return new SkylineBinAtlasPacker(); }, unlimited },
+        {
+            "skyline-rbp",
+            []() {
+                SkylineBinAtlasPacker * packer = new SkylineBinAtlasPacker();
+                packer->setEngine(OnlineAlgorithmEngine::RectangleBinPack);
+                return packer;
+            },
+            unlimited
+        },
+        {
+            "skyline-partitioned",
+            []() {
+                SkylineBinAtlasPacker * packer = new SkylineBinAtlasPacker();
+                packer->setPartitionCount(0);
+                return packer;
+            },
+            unlimited
+        },
+        { "guillotine", []() { return new GuillotineBinAtlaskPacker(); }, unlimited },
+        {
+            "guillotine-rbp",
+            []() {
+                GuillotineBinAtlaskPacker * packer = new GuillotineBinAtlaskPacker();
+                packer->setEngine(OnlineAlgorithmEngine::RectangleBinPack);
+                return packer;
+            },
+            unlimited
+        },
+        { "shelf", []() { return new ShelfBinAtlasPacker(); }, unlimited },
+        { "auto", []() { return new MetaAtlasPacker(); }, m_options.meta_limit },
+        {
+            "annealing",
+            []() {
+                AnnealingAtlasPacker * packer = new AnnealingAtlasPacker();
+                packer->setIterationLimit(g_annealing_iteration_limit);
+                return packer;
+            },
+            m_options.meta_limit
+        },
+        { "exact", []() { return new BranchAndBoundAtlasPacker(); }, g_exact_sprite_limit }
+    };
+}
+
+AtlasPackerOptions Benchmark::packerOptions()
+{
+    return AtlasPackerOptions
+    {
+        .max_atlas_size = QSize(2048, 2048),
+        .detect_duplicates = true,
+        .detect_transformed_duplicates = false,
+        .crop = true,
+        .remove_file_extensions = true
+    };
+}
+
+void Benchmark::run()
+{
+    for(SpriteDistribution distribution : m_options.distributions)
+    {
+        for(qsizetype count : m_options.sprite_counts)
+        {
+            m_log << "generating " << count << " " << SpriteGenerator::distributionName(distribution) <<
+                " sprites" << Qt::endl;
+            SpriteGenerator generator(m_options.seed);
+            const QList<Sprite> sprites = generator.generate(distribution, count);
+            runStages(distribution, sprites);
+            runPackers(distribution, sprites);
+            runOutput(distribution, sprites);
+        }
+    }
+}
+
+Benchmark::Measurement Benchmark::measure(const std::function<void()> & _function) const
+{
+    QList<qint64> samples;
+    samples.reserve(m_options.repeat);
+    for(int i = 0; i < m_options.repeat; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        _function();
+        samples.append(timer.nsecsElapsed());
+    }
+    std::sort(samples.begin(), samples.end());
+    return Measurement
+    {
+        .min_ns = samples.constFirst(),
+        .median_ns = samples[samples.count() / 2]
+    };
+}
+
+void Benchmark::report(
+    const QString & _suite,
+    const QString & _name,
+    SpriteDistribution _distribution,
+    qsizetype _sprite_count,
+    const Measurement & _measurement,
+    const QJsonObject & _extra)
+{
+    QJsonObject json
+    {
+        { "suite", _suite },
+        { "name", _name },
+        { "distribution", SpriteGenerator::distributionName(_distribution) },
+        { "sprites", static_cast<qint64>(_sprite_count) },
+        { "repeat", m_options.repeat },
+        { "min_ms", toMilliseconds(_measurement.min_ns) },
+        { "median_ms", toMilliseconds(_measurement.median_ns) }
+    };
+    for(auto it = _extra.constBegin(); it != _extra.constEnd(); ++it)
+        json.insert(it.key(), it.value());
+    m_out << QJsonDocument(json).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+void Benchmark::runStages(SpriteDistribution _distribution, const QList<Sprite> & _sprites)
+{
+    const qsizetype count = _sprites.count();
+    const QJsonObject pixels { { "pixels", calculateSpriteArea(_sprites) } };
+
+    QList<QByteArray> encoded;
+    encoded.reserve(count);
+    for(const Sprite & sprite : _sprites)
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        sprite.image.save(&buffer, g_texture_format);
+        encoded.append(data);
+    }
+    report("stage", "decode", _distribution, count, measure([&encoded]() {
+        for(const QByteArray & data : encoded)
+        {
+            const QImage image = QImage::fromData(data, g_texture_format);
+            Q_UNUSED(image)
+        }
+    }), pixels);
+
+    report("stage", "crop", _distribution, count, measure([&_sprites]() {
+        for(const Sprite & sprite : _sprites)
+            cropSprite(sprite.image);
+    }), pixels);
+
+    report("stage", "hash", _distribution, count, measure([&_sprites]() {
+        for(const Sprite & sprite : _sprites)
+            hashSprite(sprite.image, sprite.image.rect());
+    }), pixels);
+
+    report("stage", "analyze", _distribution, count, measure([&_sprites]() {
+        QPromise<void> promise;
+        AtlasPackerContext context(promise);
+        PackStatistics statistics;
+        SpriteAnalysis analysis;
+        analyzeSprites(_sprites, packerOptions(), context, statistics, analysis);
+    }), pixels);
+}
+
+void Benchmark::runPackers(SpriteDistribution _distribution, const QList<Sprite> & _sprites)
+{
+    const AtlasPackerOptions options = packerOptions();
+    for(const PackerFactory & factory : m_packers)
+    {
+        if(_sprites.count() > factory.limit)
+            continue;
+        std::unique_ptr<AtlasPacker> packer(factory.create());
+        std::unique_ptr<RawAtlasPack> pack;
+        const Measurement measurement = measure([&]() {
+            QPromise<void> promise;
+            AtlasPackerContext context(promise);
+            pack = packer->pack(context, _sprites, options);
+        });
+        QJsonObject description = describePack(*pack);
+        description.insert("statistics", pack->statistics().toJson());
+        report("packer", factory.name, _distribution, _sprites.count(), measurement, description);
+    }
+}
+
+void Benchmark::runOutput(SpriteDistribution _distribution, const QList<Sprite> & _sprites)
+{
+    const qsizetype count = _sprites.count();
+    QPromise<void> promise;
+    AtlasPackerContext context(promise);
+    std::unique_ptr<RawAtlasPack> pack = MaxRectsBinAtlasPacker().pack(context, _sprites, packerOptions());
+    const QJsonObject description = describePack(*pack);
+
+    QHash<QString, const QImage *> images;
+    images.reserve(count);
+    for(const Sprite & sprite : _sprites)
+        images.insert(QFileInfo(sprite.name).baseName(), &sprite.image);
+    QList<QList<PlacedSprite>> placements;
+    for(const RawAtlas & atlas : *pack)
+    {
+        QList<PlacedSprite> & atlas_placements = placements.emplace_back();
+        QSet<quint64> placed;
+        for(const Frame & frame : atlas.frames)
+        {
+            const quint64 key = (static_cast<quint64>(frame.texture_rect.x()) << 32) |
+                static_cast<quint32>(frame.texture_rect.y());
+            atlas_placements.append({
+                .image = placed.contains(key) ? nullptr : images.value(frame.name),
+                .frame = frame
+            });
+            placed.insert(key);
+        }
+    }
+    report("stage", "render", _distribution, count, measure([&placements]() {
+        for(const QList<PlacedSprite> & atlas_placements : placements)
+            renderSprites(atlas_placements);
+    }), description);
+
+    QTemporaryDir directory;
+    if(!directory.isValid())
+    {
+        m_log << "unable to create a temporary directory, output stages skipped" << Qt::endl;
+        return;
+    }
+    const QDir atlas_directory(directory.path());
+    report("stage", "save", _distribution, count, measure([&]() {
+        pack->save(atlas_directory, g_atlas_name, g_texture_format, QString(), TextureOptions());
+    }), description);
+
+    QList<Atlas> atlases;
+    Sol2dAtlasSerializer serializer;
+    const QStringList atlas_files = atlas_directory.entryList(
+        { QString("*.%1").arg(serializer.defaultFileExtenstion()) },
+        QDir::Files);
+    report("stage", "deserialize", _distribution, count, measure([&]() {
+        atlases.clear();
+        for(const QString & file : atlas_files)
+            serializer.deserialize(atlas_directory.absoluteFilePath(file), atlases.emplace_back());
+    }), description);
+
+    const QString serialized_file = atlas_directory.absoluteFilePath("serialized.xml");
+    report("stage", "serialize", _distribution, count, measure([&]() {
+        for(const Atlas & atlas : atlases)
+            serializer.serialize(atlas, serialized_file);
+    }), description);
+
+    QTemporaryDir unpack_directory;
+    report("stage", "unpack", _distribution, count, measure([&]() {
+        for(const Atlas & atlas : atlases)
+            AtlasPack(atlas).unpack(QDir(unpack_directory.path()), g_texture_format);
+    }), description);
+}
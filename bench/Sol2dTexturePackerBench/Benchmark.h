@@ -0,0 +1,77 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <Sol2dTexturePackerBench/SpriteGenerator.h>
+#include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
+#include <QJsonObject>
+#include <QTextStream>
+#include <functional>
+
+struct BenchmarkOptions
+{
+    QList<qsizetype> sprite_counts;
+    QList<SpriteDistribution> distributions;
+    int repeat;
+    qsizetype meta_limit;
+    quint64 seed;
+};
+
+class Benchmark final
+{
+    Q_DISABLE_COPY_MOVE(Benchmark)
+
+private:
+    struct Measurement
+    {
+        qint64 min_ns;
+        qint64 median_ns;
+    };
+
+    struct PackerFactory
+    {
+        QString name;
+        std::function<AtlasPacker * ()> create;
+        qsizetype limit;
+    };
+
+public:
+    Benchmark(const BenchmarkOptions & _options, QTextStream & _out, QTextStream & _log);
+    void run();
+
+private:
+    void runStages(SpriteDistribution _distribution, const QList<Sprite> & _sprites);
+    void runPackers(SpriteDistribution _distribution, const QList<Sprite> & _sprites);
+    void runOutput(SpriteDistribution _distribution, const QList<Sprite> & _sprites);
+    Measurement measure(const std::function<void()> & _function) const;
+    void report(
+        const QString & _suite,
+        const QString & _name,
+        SpriteDistribution _distribution,
+        qsizetype _sprite_count,
+        const Measurement & _measurement,
+        const QJsonObject & _extra = QJsonObject());
+    static AtlasPackerOptions packerOptions();
+
+private:
+    const BenchmarkOptions m_options;
+    QTextStream & m_out;
+    QTextStream & m_log;
+    QList<PackerFactory> m_packers;
+};
@@ -0,0 +1,167 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <Sol2dTexturePackerBench/Benchmark.h>
+#include <LibSol2dTexturePacker/Exception.h>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+struct ExitCodes
+{
+    enum Codes : int
+    {
+        Success = 0,
+        Error = 1,
+        InvalidArgumentValue = 11
+    };
+};
+
+bool parseDistributions(const QString & _value, QList<SpriteDistribution> & _distributions)
+{
+    const SpriteDistribution all[] =
+    {
+        SpriteDistribution::Uniform,
+        SpriteDistribution::PowerLaw,
+        SpriteDistribution::Transparent,
+        SpriteDistribution::Duplicates
+    };
+    foreach(const QString & name, _value.split(',', Qt::SkipEmptyParts))
+    {
+        auto it = std::find_if(std::begin(all), std::end(all), [&name](SpriteDistribution __distribution) {
+            return SpriteGenerator::distributionName(__distribution) == name.trimmed();
+        });
+        if(it == std::end(all))
+            return false;
+        _distributions.append(*it);
+    }
+    return !_distributions.isEmpty();
+}
+
+bool parseSizes(const QString & _value, QList<qsizetype> & _sizes)
+{
+    foreach(const QString & item, _value.split(',', Qt::SkipEmptyParts))
+    {
+        bool ok;
+        const qsizetype size = item.trimmed().toLongLong(&ok);
+        if(!ok || size <= 0)
+            return false;
+        _sizes.append(size);
+    }
+    return !_sizes.isEmpty();
+}
+
+} // namespace
+
+int main(int _argc, char * _argv[])
+{
+    QCoreApplication app(_argc, _argv);
+    QCoreApplication::setApplicationName(__S2TP_BIN);
+    QCoreApplication::setApplicationVersion(__S2TP_VERSION);
+    QCoreApplication::setOrganizationName(__S2TP_ORG);
+
+    QTextStream out(stdout, QIODevice::WriteOnly);
+    QTextStream err(stderr, QIODevice::WriteOnly);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QObject::tr("Measures every packing stage and prints one JSON object per measurement"));
+    parser.addHelpOption();
+    const QCommandLineOption sizes_option
+    {
+        { "n", "sizes" },
+        QObject::tr("Comma-separated sprite counts (default: 100,1000,10000,100000)"),
+        QObject::tr("counts"),
+        "100,1000,10000,100000"
+    };
+    const QCommandLineOption distributions_option
+    {
+        { "d", "distributions" },
+        QObject::tr("Comma-separated sprite distributions: uniform, power-law, transparent, duplicates (default: all)"),
+        QObject::tr("names"),
+        "uniform,power-law,transparent,duplicates"
+    };
+    const QCommandLineOption repeat_option
+    {
+        { "r", "repeat" },
+        QObject::tr("Number of runs per measurement (default: 3)"),
+        QObject::tr("count"),
+        "3"
+    };
+    const QCommandLineOption meta_limit_option
+    {
+        { "m", "meta-limit" },
+        QObject::tr("Maximum sprite count for the auto packer (default: 1000)"),
+        QObject::tr("count"),
+        "1000"
+    };
+    const QCommandLineOption seed_option
+    {
+        { "s", "seed" },
+        QObject::tr("Sprite generator seed (default: 1)"),
+        QObject::tr("value"),
+        "1"
+    };
+    parser.addOptions({ sizes_option, distributions_option, repeat_option, meta_limit_option, seed_option });
+    parser.process(app);
+
+    BenchmarkOptions options {};
+    bool ok = true;
+    if(!parseSizes(parser.value(sizes_option), options.sprite_counts))
+    {
+        err << QObject::tr("Invalid sprite counts") << ": " << parser.value(sizes_option) << Qt::endl;
+        return ExitCodes::InvalidArgumentValue;
+    }
+    if(!parseDistributions(parser.value(distributions_option), options.distributions))
+    {
+        err << QObject::tr("Invalid distributions") << ": " << parser.value(distributions_option) << Qt::endl;
+        return ExitCodes::InvalidArgumentValue;
+    }
+    options.repeat = parser.value(repeat_option).toInt(&ok);
+    if(!ok || options.repeat <= 0)
+    {
+        err << QObject::tr("Invalid repeat count") << ": " << parser.value(repeat_option) << Qt::endl;
+        return ExitCodes::InvalidArgumentValue;
+    }
+    options.meta_limit = parser.value(meta_limit_option).toLongLong(&ok);
+    if(!ok || options.meta_limit < 0)
+    {
+        err << QObject::tr("Invalid auto packer limit") << ": " << parser.value(meta_limit_option) << Qt::endl;
+        return ExitCodes::InvalidArgumentValue;
+    }
+    options.seed = parser.value(seed_option).toULongLong(&ok);
+    if(!ok)
+    {
+        err << QObject::tr("Invalid seed") << ": " << parser.value(seed_option) << Qt::endl;
+        return ExitCodes::InvalidArgumentValue;
+    }
+
+    try
+    {
+        Benchmark(options, out, err).run();
+        return ExitCodes::Success;
+    }
+    catch(const Exception & e)
+    {
+        err << e.message() << Qt::endl;
+        return ExitCodes::Error;
+    }
+}
@@ -0,0 +1,167 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <Sol2dTexturePackerBench/SpriteGenerator.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int g_uniform_sprite_size = 32;
+const int g_min_power_law_sprite_size = 8;
+const int g_max_power_law_sprite_size = 256;
+const double g_power_law_exponent = 2.5;
+const int g_min_transparent_sprite_size = 64;
+const int g_max_transparent_sprite_size = 128;
+const int g_duplicate_ratio = 10;
+
+} // namespace
+
+SpriteGenerator::SpriteGenerator(quint64 _seed) :
+    m_state(_seed)
+{
+}
+
+// SplitMix64: the standard library distributions are implementation-defined,
+// so the generator is hand-rolled to produce the same sprites on every platform.
+quint64 SpriteGenerator::next()
+{
+    quint64 z = (m_state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+int SpriteGenerator::nextInt(int _min, int _max)
+{
+    return _min + static_cast<int>(next() % static_cast<quint64>(_max - _min + 1));
+}
+
+double SpriteGenerator::nextDouble()
+{
+    return static_cast<double>(next() >> 11) / static_cast<double>(1ull << 53);
+}
+
+QSize SpriteGenerator::nextPowerLawSize()
+{
+    auto sample = [this]() {
+        const double size = g_min_power_law_sprite_size *
+            std::pow(1.0 - nextDouble(), -1.0 / (g_power_law_exponent - 1.0));
+        return static_cast<int>(std::min<double>(size, g_max_power_law_sprite_size));
+    };
+    const int width = sample();
+    return QSize(width, std::clamp(
+        static_cast<int>(width * (0.5 + nextDouble())),
+        g_min_power_law_sprite_size,
+        g_max_power_law_sprite_size));
+}
+
+QImage SpriteGenerator::makeImage(int _width, int _height, const QRect & _opaque_rect)
+{
+    QImage image(_width, _height, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    const QRgb base = static_cast<QRgb>(next()) | 0xff000000u;
+    for(int y = _opaque_rect.top(); y <= _opaque_rect.bottom(); ++y)
+    {
+        QRgb * line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for(int x = _opaque_rect.left(); x <= _opaque_rect.right(); ++x)
+            line[x] = base ^ static_cast<QRgb>(((x * 31) ^ (y * 17)) & 0xff);
+    }
+    // Packers receive sprites the way the applications load them
+    return normalizeSpriteImage(image);
+}
+
+QList<Sprite> SpriteGenerator::generate(SpriteDistribution _distribution, qsizetype _count)
+{
+    QList<Sprite> sprites;
+    sprites.reserve(_count);
+    QList<QImage> pool;
+    if(_distribution == SpriteDistribution::Duplicates)
+    {
+        const qsizetype pool_size = std::max<qsizetype>(1, _count / g_duplicate_ratio);
+        pool.reserve(pool_size);
+        for(qsizetype i = 0; i < pool_size; ++i)
+        {
+            const QSize size = nextPowerLawSize();
+            pool.append(makeImage(size.width(), size.height(), QRect(QPoint(0, 0), size)));
+        }
+    }
+    for(qsizetype i = 0; i < _count; ++i)
+    {
+        QImage image;
+        switch(_distribution)
+        {
+        case SpriteDistribution::Uniform:
+            image = makeImage(
+                g_uniform_sprite_size,
+                g_uniform_sprite_size,
+                QRect(0, 0, g_uniform_sprite_size, g_uniform_sprite_size));
+            break;
+        case SpriteDistribution::PowerLaw:
+        {
+            const QSize size = nextPowerLawSize();
+            image = makeImage(size.width(), size.height(), QRect(QPoint(0, 0), size));
+            break;
+        }
+        case SpriteDistribution::Transparent:
+        {
+            const int width = nextInt(g_min_transparent_sprite_size, g_max_transparent_sprite_size);
+            const int height = nextInt(g_min_transparent_sprite_size, g_max_transparent_sprite_size);
+            const int opaque_width = nextInt(1, width / 4);
+            const int opaque_height = nextInt(1, height / 4);
+            image = makeImage(
+                width,
+                height,
+                QRect(
+                    nextInt(0, width - opaque_width),
+                    nextInt(0, height - opaque_height),
+                    opaque_width,
+                    opaque_height));
+            break;
+        }
+        case SpriteDistribution::Duplicates:
+            image = pool[static_cast<qsizetype>(next() % static_cast<quint64>(pool.count()))];
+            break;
+        }
+        const QString name = QString("sprite_%1.png").arg(i, 6, 10, QChar('0'));
+        sprites.append({
+            .path = name,
+            .name = name,
+            .image = image
+        });
+    }
+    return sprites;
+}
+
+QString SpriteGenerator::distributionName(SpriteDistribution _distribution)
+{
+    switch(_distribution)
+    {
+    case SpriteDistribution::Uniform:
+        return "uniform";
+    case SpriteDistribution::PowerLaw:
+        return "power-law";
+    case SpriteDistribution::Transparent:
+        return "transparent";
+    case SpriteDistribution::Duplicates:
+        return "duplicates";
+    default:
+        return QString();
+    }
+}
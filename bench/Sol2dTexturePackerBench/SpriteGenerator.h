@@ -0,0 +1,48 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Sprite.h>
+#include <QList>
+
+enum class SpriteDistribution
+{
+    Uniform,
+    PowerLaw,
+    Transparent,
+    Duplicates
+};
+
+class SpriteGenerator final
+{
+public:
+    explicit SpriteGenerator(quint64 _seed);
+    QList<Sprite> generate(SpriteDistribution _distribution, qsizetype _count);
+    static QString distributionName(SpriteDistribution _distribution);
+
+private:
+    quint64 next();
+    int nextInt(int _min, int _max);
+    double nextDouble();
+    QImage makeImage(int _width, int _height, const QRect & _opaque_rect);
+    QSize nextPowerLawSize();
+
+private:
+    quint64 m_state;
+};
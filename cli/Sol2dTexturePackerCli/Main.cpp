@@ -24,13 +24,20 @@
 #include <LibSol2dTexturePacker/Packers/GuillotineBinAtlaskPacker.h>
 #include <LibSol2dTexturePacker/Packers/ShelfBinAtlasPacker.h>
 #include <LibSol2dTexturePacker/Packers/MetaAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/AnnealingAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/BranchAndBoundAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Packers/AtlasScaling.h>
+#include <LibSol2dTexturePacker/Atlas/Sol2dAtlasSerializer.h>
 #include <LibSol2dTexturePacker/Exception.h>
 #include <QImageWriter>
+#include <QColor>
 #include <QCommandLineParser>
 #include <QIODevice>
 #include <QTextStream>
 #include <QMap>
 #include <QtGlobal>
+#include <QtPlugin>
 #include <memory>
 #include <functional>
 
@@ -60,7 +67,12 @@ struct AlgorithmConfigurationAdapter
         OptionFlagNone = 0x0,
         OptionFlagAllowFlip = 0x1,
         OptionFlagAllowMerge = 0x2,
-        OptionFlagUseWasteMap = 0x4
+        OptionFlagUseWasteMap = 0x4,
+        OptionFlagTimeBudget = 0x8,
+        OptionFlagTolerance = 0x10,
+        OptionFlagIterationLimit = 0x20,
+        OptionFlagSeed = 0x40,
+        OptionFlagPartitions = 0x80
     };
 
     struct Heuristic
@@ -77,6 +89,16 @@ struct AlgorithmConfigurationAdapter
     AlgoritmOptions algoritm_options;
 };
 
+void setTimeBudget(AtlasPacker * _packer, qint64 _budget)
+{
+    if(MetaAtlasPacker * meta_packer = dynamic_cast<MetaAtlasPacker *>(_packer))
+        meta_packer->setTimeBudget(_budget);
+    else if(AnnealingAtlasPacker * annealing_packer = dynamic_cast<AnnealingAtlasPacker *>(_packer))
+        annealing_packer->setTimeBudget(_budget);
+    else if(BranchAndBoundAtlasPacker * exact_packer = dynamic_cast<BranchAndBoundAtlasPacker *>(_packer))
+        exact_packer->setTimeBudget(_budget);
+}
+
 QString joinOptionNames(const QStringList & _flags)
 {
     QString result;
@@ -306,7 +328,9 @@ std::unique_ptr<Application> AppRunner::parsePack() const
                 if(__flags & AlgorithmConfigurationAdapter::OptionFlagAllowFlip)
                     static_cast<MaxRectsBinAtlasPacker *>(__packer)->allowFlip(true);
              },
-            .algoritm_options = AlgorithmConfigurationAdapter::OptionFlagAllowFlip
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagAllowFlip |
+                AlgorithmConfigurationAdapter::OptionFlagPartitions)
         },
         {
             .name = "skyline",
@@ -341,7 +365,9 @@ std::unique_ptr<Application> AppRunner::parsePack() const
                 if(__flags & AlgorithmConfigurationAdapter::OptionFlagUseWasteMap)
                     static_cast<SkylineBinAtlasPacker *>(__packer)->enableWasteMap(true);
              },
-            .algoritm_options = AlgorithmConfigurationAdapter::OptionFlagUseWasteMap
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagUseWasteMap |
+                AlgorithmConfigurationAdapter::OptionFlagPartitions)
         },
         {
             .name = "guillotine",
@@ -488,7 +514,9 @@ std::unique_ptr<Application> AppRunner::parsePack() const
                 if(__flags & AlgorithmConfigurationAdapter::OptionFlagAllowMerge)
                     static_cast<GuillotineBinAtlaskPacker *>(__packer)->enableMerge(true);
             },
-            .algoritm_options = AlgorithmConfigurationAdapter::OptionFlagAllowMerge
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagAllowMerge |
+                AlgorithmConfigurationAdapter::OptionFlagPartitions)
         },
         {
             .name = "shelf",
@@ -567,15 +595,149 @@ std::unique_ptr<Application> AppRunner::parsePack() const
                 if(__flags & AlgorithmConfigurationAdapter::OptionFlagUseWasteMap)
                     static_cast<ShelfBinAtlasPacker *>(__packer)->enableWasteMap(true);
             },
-            .algoritm_options = AlgorithmConfigurationAdapter::OptionFlagUseWasteMap
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagUseWasteMap |
+                AlgorithmConfigurationAdapter::OptionFlagPartitions)
         },
         {
             .name = "auto",
-            .choice_heuristics = {},
+            .choice_heuristics = {
+                {
+                    "AREA",
+                    {
+                        .description = QObject::tr("Minimal total atlas area"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<MetaAtlasPacker *>(__packer)->setCostModel(
+                                AtlasPackCostModel::create(AtlasPackCostModelType::TotalArea));
+                        }
+                    }
+                },
+                {
+                    "COUNT",
+                    {
+                        .description = QObject::tr("Minimal number of atlases, then minimal total area"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<MetaAtlasPacker *>(__packer)->setCostModel(
+                                AtlasPackCostModel::create(AtlasPackCostModelType::AtlasCountThenArea));
+                        }
+                    }
+                },
+                {
+                    "VRAM",
+                    {
+                        .description = QObject::tr("Minimal video memory of atlases padded to powers of two"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<MetaAtlasPacker *>(__packer)->setCostModel(
+                                AtlasPackCostModel::create(AtlasPackCostModelType::VideoMemory));
+                        }
+                    }
+                },
+                {
+                    "SIZE",
+                    {
+                        .description = QObject::tr("Minimal estimated size of encoded atlases"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<MetaAtlasPacker *>(__packer)->setCostModel(
+                                AtlasPackCostModel::create(AtlasPackCostModelType::CompressedSize));
+                        }
+                    }
+                }
+            },
             .split_heuristics = {},
             .create = []() { return new MetaAtlasPacker(); },
             .set_options = [](AtlasPacker *, int) {},
-            .algoritm_options = AlgorithmConfigurationAdapter::OptionFlagNone
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagTimeBudget |
+                AlgorithmConfigurationAdapter::OptionFlagTolerance)
+        },
+        {
+            .name = "annealing",
+            .choice_heuristics =
+            {
+                {
+                    "BLSF",
+                    {
+                        .description = QObject::tr("Best Long Side Fit"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<AnnealingAtlasPacker *>(__packer)->setChoiceHeuristic(
+                                MaxRectsBinAtlasPackerChoiceHeuristic::BestLongSideFit);
+                        }
+                    }
+                },
+                {
+                    "BSSF",
+                    {
+                        .description = QObject::tr("Best Short Side Fit (default)"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<AnnealingAtlasPacker *>(__packer)->setChoiceHeuristic(
+                                MaxRectsBinAtlasPackerChoiceHeuristic::BestShortSideFit);
+                        }
+                    }
+                },
+                {
+                    "BAF",
+                    {
+                        .description = QObject::tr("Best Area Fit"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<AnnealingAtlasPacker *>(__packer)->setChoiceHeuristic(
+                                MaxRectsBinAtlasPackerChoiceHeuristic::BestAreaFit);
+                        }
+                    }
+                },
+                {
+                    "BL",
+                    {
+                        .description = QObject::tr("Bottom Left Rule"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<AnnealingAtlasPacker *>(__packer)->setChoiceHeuristic(
+                                MaxRectsBinAtlasPackerChoiceHeuristic::BottomLeftRule);
+                        }
+                    }
+                },
+                {
+                    "CP",
+                    {
+                        .description = QObject::tr("Contact Point Rule"),
+                        .set = [](AtlasPacker * __packer)
+                        {
+                            static_cast<AnnealingAtlasPacker *>(__packer)->setChoiceHeuristic(
+                                MaxRectsBinAtlasPackerChoiceHeuristic::ContactPointRule);
+                        }
+                    }
+                }
+            },
+            .split_heuristics = {},
+            .create = []() { return new AnnealingAtlasPacker(); },
+            .set_options = [](AtlasPacker * __packer, int __flags) {
+                static_cast<AnnealingAtlasPacker *>(__packer)->allowFlip(
+                    __flags & AlgorithmConfigurationAdapter::OptionFlagAllowFlip);
+            },
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagAllowFlip |
+                AlgorithmConfigurationAdapter::OptionFlagTimeBudget |
+                AlgorithmConfigurationAdapter::OptionFlagIterationLimit |
+                AlgorithmConfigurationAdapter::OptionFlagSeed)
+        },
+        {
+            .name = "exact",
+            .choice_heuristics = {},
+            .split_heuristics = {},
+            .create = []() { return new BranchAndBoundAtlasPacker(); },
+            .set_options = [](AtlasPacker * __packer, int __flags) {
+                static_cast<BranchAndBoundAtlasPacker *>(__packer)->allowFlip(
+                    __flags & AlgorithmConfigurationAdapter::OptionFlagAllowFlip);
+            },
+            .algoritm_options = static_cast<AlgorithmConfigurationAdapter::AlgoritmOptions>(
+                AlgorithmConfigurationAdapter::OptionFlagAllowFlip |
+                AlgorithmConfigurationAdapter::OptionFlagTimeBudget)
         }
     };
 
@@ -613,6 +775,38 @@ std::unique_ptr<Application> AppRunner::parsePack() const
         { "w", "use-waste-map" },
         QObject::tr("Algorithm-specific option that enables the use of a waste map")
     };
+    const QCommandLineOption time_budget_option
+    {
+        { "b", "time-budget" },
+        QObject::tr("Algorithm-specific option that limits the search time, the best layout found so far is used"),
+        QObject::tr("value in milliseconds")
+    };
+    const QCommandLineOption tolerance_option
+    {
+        { "l", "tolerance" },
+        QObject::tr("Algorithm-specific option that stops the search once the layout is within "
+            "the given fraction of the theoretical optimum (default: 0)"),
+        QObject::tr("fraction")
+    };
+    const QCommandLineOption iteration_limit_option
+    {
+        { "i", "iterations" },
+        QObject::tr("Algorithm-specific option that limits the number of layouts each search thread evaluates"),
+        QObject::tr("count")
+    };
+    const QCommandLineOption seed_option
+    {
+        QStringList { "seed" },
+        QObject::tr("Algorithm-specific option that sets the seed of the random search (default: 1)"),
+        QObject::tr("value")
+    };
+    const QCommandLineOption partitions_option
+    {
+        { "j", "partitions" },
+        QObject::tr("Algorithm-specific option that packs large sets in the given number of concurrent partitions, "
+            "0 means one partition per processor core (default: 1)"),
+        QObject::tr("count")
+    };
     const QCommandLineOption output_directory_option
     {
         { "o", "output" },
@@ -652,11 +846,21 @@ std::unique_ptr<Application> AppRunner::parsePack() const
         { "d", "detect-duplicates" },
         QObject::tr("Remove duplicates sprites to save space in the atlas")
     };
+    const QCommandLineOption detect_transformed_duplicates_option
+    {
+        { "g", "detect-transformed" },
+        QObject::tr("Detect mirrored and rotated duplicates, requires --detect-duplicates")
+    };
     const QCommandLineOption remove_file_ext_option
     {
         { "e", "remove-ext" },
         QObject::tr("Remove file extensions from frame names")
     };
+    const QCommandLineOption premultiply_alpha_option
+    {
+        QStringList { "premultiply-alpha" },
+        QObject::tr("Write the texture with the colors multiplied by alpha")
+    };
     const QCommandLineOption format_option
     {
         { "t", "format" },
@@ -669,6 +873,51 @@ std::unique_ptr<Application> AppRunner::parsePack() const
         QObject::tr("A color that should be interpreted as alpha"),
         QObject::tr("Hex color (e.g., #e6b800)")
     };
+    const QCommandLineOption apply_alpha_option
+    {
+        { "k", "apply-alpha" },
+        QObject::tr("Make the --alpha color transparent before cropping instead of recording it in the atlas")
+    };
+    const QCommandLineOption pixel_format_option
+    {
+        QStringList { "pixel-format" },
+        QObject::tr("Texture pixel precision: rgba8888, rgb888, rgba4444, rgb565, rgba5551, a8, l8 or indexed8 (default: rgba8888)"),
+        QObject::tr("pixel format")
+    };
+    const QCommandLineOption dithering_option
+    {
+        QStringList { "dithering" },
+        QObject::tr("Dithering for reduced pixel formats: none, ordered or floyd-steinberg (default: none)"),
+        QObject::tr("dithering")
+    };
+    const QCommandLineOption strip_alpha_option
+    {
+        QStringList { "strip-alpha" },
+        QObject::tr("Write rgba8888 atlases without transparent pixels as rgb888, or as l8 when they are gray")
+    };
+    const QCommandLineOption compression_option
+    {
+        QStringList { "compression" },
+        QObject::tr("GPU texture compression: none, bc1 or bc3 (default: none), requires the dds or ktx2 format"),
+        QObject::tr("compression")
+    };
+    const QCommandLineOption scales_option
+    {
+        QStringList { "scales" },
+        QObject::tr("Pack once and write an atlas for each scale, the sprites are drawn for the largest one "
+            "and every other scale must divide it"),
+        QObject::tr("comma separated scales (e.g., 1,2,4)")
+    };
+    const QCommandLineOption stats_option
+    {
+        QStringList { "stats" },
+        QObject::tr("Print per-phase timings and counters as JSON")
+    };
+    const QCommandLineOption progress_option
+    {
+        QStringList { "progress" },
+        QObject::tr("Print packing progress and estimated remaining time to stderr")
+    };
     const QList options
     {
         m_help_options,
@@ -678,15 +927,30 @@ std::unique_ptr<Application> AppRunner::parsePack() const
         allow_flip_option,
         use_waste_map_option,
         allow_merge_option,
+        time_budget_option,
+        tolerance_option,
+        iteration_limit_option,
+        seed_option,
+        partitions_option,
         output_directory_option,
         output_name_option,
         max_width_option,
         max_height_option,
         crop_option,
         detect_duplicates_option,
+        detect_transformed_duplicates_option,
         remove_file_ext_option,
+        premultiply_alpha_option,
         format_option,
-        alpha_color_option
+        alpha_color_option,
+        apply_alpha_option,
+        pixel_format_option,
+        dithering_option,
+        strip_alpha_option,
+        compression_option,
+        scales_option,
+        stats_option,
+        progress_option
     };
     parser.addOptions(options);
 
@@ -734,6 +998,16 @@ std::unique_ptr<Application> AppRunner::parsePack() const
                     m_io.out << "    " << joinOptionNames(use_waste_map_option.names()) << Qt::endl;
                 if(alg.algoritm_options & AlgorithmConfigurationAdapter::OptionFlagAllowMerge)
                     m_io.out << "    " <<  joinOptionNames(allow_merge_option.names()) << Qt::endl;
+                if(alg.algoritm_options & AlgorithmConfigurationAdapter::OptionFlagTimeBudget)
+                    m_io.out << "    " << joinOptionNames(time_budget_option.names()) << Qt::endl;
+                if(alg.algoritm_options & AlgorithmConfigurationAdapter::OptionFlagTolerance)
+                    m_io.out << "    " << joinOptionNames(tolerance_option.names()) << Qt::endl;
+                if(alg.algoritm_options & AlgorithmConfigurationAdapter::OptionFlagIterationLimit)
+                    m_io.out << "    " << joinOptionNames(iteration_limit_option.names()) << Qt::endl;
+                if(alg.algoritm_options & AlgorithmConfigurationAdapter::OptionFlagSeed)
+                    m_io.out << "    " << joinOptionNames(seed_option.names()) << Qt::endl;
+                if(alg.algoritm_options & AlgorithmConfigurationAdapter::OptionFlagPartitions)
+                    m_io.out << "    " << joinOptionNames(partitions_option.names()) << Qt::endl;
             }
         }
         m_io.out << Qt::endl;
@@ -745,8 +1019,10 @@ std::unique_ptr<Application> AppRunner::parsePack() const
     {
         .max_atlas_size = QSize(default_atlas_size, default_atlas_size),
         .detect_duplicates = parser.isSet(detect_duplicates_option.names().constFirst()),
+        .detect_transformed_duplicates = parser.isSet(detect_transformed_duplicates_option.names().constFirst()),
         .crop = parser.isSet(crop_option.names().constFirst()),
-        .remove_file_extensions = parser.isSet(remove_file_ext_option.names().constFirst())
+        .remove_file_extensions = parser.isSet(remove_file_ext_option.names().constFirst()),
+        .premultiply_alpha = parser.isSet(premultiply_alpha_option.names().constFirst())
     };
     if(parser.isSet(max_width_option.names().constFirst()))
     {
@@ -778,20 +1054,106 @@ std::unique_ptr<Application> AppRunner::parsePack() const
             return noop(ExitCodes::InvalidArgumentValue);
         }
     }
+    QString color_to_alpha = parser.isSet(alpha_color_option.names().constFirst())
+        ? parser.value(alpha_color_option.names().constFirst())
+        : QString();
+    if(parser.isSet(apply_alpha_option.names().constFirst()))
+    {
+        const QColor color = QColor::fromString(color_to_alpha);
+        if(!color.isValid())
+        {
+            m_io.err << QObject::tr("Invalid or missing alpha color") << ": " << color_to_alpha << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        // The texture has a real alpha channel, there is nothing left for readers to do
+        atlas_packer_options.color_to_alpha = color.rgb();
+        color_to_alpha.clear();
+    }
+    TextureOptions texture_options;
+    texture_options.strip_opaque_alpha = parser.isSet(strip_alpha_option.names().constFirst());
+    if(parser.isSet(pixel_format_option.names().constFirst()))
+    {
+        const std::optional<TexturePixelFormat> pixel_format =
+            parseTexturePixelFormat(parser.value(pixel_format_option.names().constFirst()));
+        if(!pixel_format)
+        {
+            m_io.err << QObject::tr("Invalid or unsupported pixel format") << ": " <<
+                parser.value(pixel_format_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        texture_options.pixel_format = *pixel_format;
+    }
+    if(parser.isSet(dithering_option.names().constFirst()))
+    {
+        const std::optional<TextureDithering> dithering =
+            parseTextureDithering(parser.value(dithering_option.names().constFirst()));
+        if(!dithering)
+        {
+            m_io.err << QObject::tr("Invalid or unsupported dithering") << ": " <<
+                parser.value(dithering_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        texture_options.dithering = *dithering;
+    }
+    if(parser.isSet(compression_option.names().constFirst()))
+    {
+        const std::optional<TextureCompression> compression =
+            parseTextureCompression(parser.value(compression_option.names().constFirst()));
+        if(!compression)
+        {
+            m_io.err << QObject::tr("Invalid or unsupported compression") << ": " <<
+                parser.value(compression_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        texture_options.compression = *compression;
+    }
+    const QString image_format = parser.isSet(format_option.names().constFirst())
+        ? parser.value(format_option.names().constFirst())
+        : default_format;
+    if(texture_options.compression != TextureCompression::None)
+    {
+        if(!isCompressedTextureContainer(image_format))
+        {
+            m_io.err << QObject::tr("Compressed textures require the dds or ktx2 format") << ": " <<
+                image_format << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        atlas_packer_options.block_size = g_texture_compression_block_size;
+    }
+    QList<int> scales;
+    if(parser.isSet(scales_option.names().constFirst()))
+    {
+        const std::optional<QList<int>> parsed_scales =
+            parseAtlasScales(parser.value(scales_option.names().constFirst()));
+        if(!parsed_scales)
+        {
+            m_io.err << QObject::tr("Invalid scales") << ": " <<
+                parser.value(scales_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        scales = *parsed_scales;
+        // Compressed blocks stay whole at the smallest scale too
+        atlas_packer_options.scale_lattice = atlasScaleLattice(scales);
+        atlas_packer_options.block_size *= atlas_packer_options.scale_lattice;
+    }
 
     QList<Sprite> sprites;
     sprites.reserve(parser.positionalArguments().count());
-    foreach(const QString & arg, parser.positionalArguments())
-    {
-        QFileInfo fi(arg);
-        QImage image;
-        if(!image.load(fi.absoluteFilePath()))
-            throw ImageLoadingException(fi.absoluteFilePath());
-        sprites.append({
-            .path = fi.absoluteFilePath(),
-            .name = fi.fileName(),
-            .image = image
-        });
+    PackPhaseTime decode_time;
+    {
+        PackPhaseTimer timer(decode_time);
+        foreach(const QString & arg, parser.positionalArguments())
+        {
+            QFileInfo fi(arg);
+            QImage image;
+            if(!image.load(fi.absoluteFilePath()))
+                throw ImageLoadingException(fi.absoluteFilePath());
+            sprites.append({
+                .path = fi.absoluteFilePath(),
+                .name = fi.fileName(),
+                .image = normalizeSpriteImage(image)
+            });
+        }
     }
     if(sprites.count() == 0)
     {
@@ -803,7 +1165,7 @@ std::unique_ptr<Application> AppRunner::parsePack() const
     if(parser.isSet(algorithm_option.names().constFirst()))
     {
         const QString algoritm_name = parser.value(algorithm_option.names().constFirst());
-        for(auto algoritm : algoritms)
+        for(auto & algoritm : algoritms)
         {
             if(algoritm_name == algoritm.name)
             {
@@ -855,6 +1217,66 @@ std::unique_ptr<Application> AppRunner::parsePack() const
     if(parser.isSet(use_waste_map_option.names().constFirst()))
         option_flags |= AlgorithmConfigurationAdapter::OptionFlagUseWasteMap;
     algorithm_config->set_options(packer.get(), option_flags);
+    if(parser.isSet(time_budget_option.names().constFirst()))
+    {
+        bool ok;
+        qint64 budget = parser.value(time_budget_option.names().constFirst()).toLongLong(&ok);
+        if(!ok || budget <= 0 || !(algorithm_config->algoritm_options & AlgorithmConfigurationAdapter::OptionFlagTimeBudget))
+        {
+            m_io.err << QObject::tr("Invalid or unsupported time budget") << ": " <<
+                parser.value(time_budget_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        setTimeBudget(packer.get(), budget);
+    }
+    if(parser.isSet(tolerance_option.names().constFirst()))
+    {
+        bool ok;
+        double tolerance = parser.value(tolerance_option.names().constFirst()).toDouble(&ok);
+        if(!ok || tolerance < 0.0 || !(algorithm_config->algoritm_options & AlgorithmConfigurationAdapter::OptionFlagTolerance))
+        {
+            m_io.err << QObject::tr("Invalid or unsupported tolerance") << ": " <<
+                parser.value(tolerance_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        static_cast<MetaAtlasPacker *>(packer.get())->setTolerance(tolerance);
+    }
+    if(parser.isSet(iteration_limit_option.names().constFirst()))
+    {
+        bool ok;
+        qint64 iterations = parser.value(iteration_limit_option.names().constFirst()).toLongLong(&ok);
+        if(!ok || iterations <= 0 || !(algorithm_config->algoritm_options & AlgorithmConfigurationAdapter::OptionFlagIterationLimit))
+        {
+            m_io.err << QObject::tr("Invalid or unsupported iteration limit") << ": " <<
+                parser.value(iteration_limit_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        static_cast<AnnealingAtlasPacker *>(packer.get())->setIterationLimit(iterations);
+    }
+    if(parser.isSet(seed_option.names().constFirst()))
+    {
+        bool ok;
+        quint32 seed = parser.value(seed_option.names().constFirst()).toUInt(&ok);
+        if(!ok || !(algorithm_config->algoritm_options & AlgorithmConfigurationAdapter::OptionFlagSeed))
+        {
+            m_io.err << QObject::tr("Invalid or unsupported seed") << ": " <<
+                parser.value(seed_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        static_cast<AnnealingAtlasPacker *>(packer.get())->setSeed(seed);
+    }
+    if(parser.isSet(partitions_option.names().constFirst()))
+    {
+        bool ok;
+        int partitions = parser.value(partitions_option.names().constFirst()).toInt(&ok);
+        if(!ok || partitions < 0 || !(algorithm_config->algoritm_options & AlgorithmConfigurationAdapter::OptionFlagPartitions))
+        {
+            m_io.err << QObject::tr("Invalid or unsupported partition count") << ": " <<
+                parser.value(partitions_option.names().constFirst()) << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        static_cast<OnlineAlgorithmAtlasPacker *>(packer.get())->setPartitionCount(partitions);
+    }
 
     return std::unique_ptr<Application>(new PackApplication(
         std::move(sprites),
@@ -866,12 +1288,13 @@ std::unique_ptr<Application> AppRunner::parsePack() const
         parser.isSet(output_name_option.names().constFirst())
             ? parser.value(output_name_option.names().constFirst())
             : default_atlas_name,
-        parser.isSet(format_option.names().constFirst())
-            ? parser.value(format_option.names().constFirst())
-            : default_format,
-        parser.isSet(alpha_color_option.names().constFirst())
-            ? parser.value(alpha_color_option.names().constFirst())
-            : QString()
+        image_format,
+        color_to_alpha,
+        texture_options,
+        scales,
+        decode_time,
+        parser.isSet(stats_option.names().constFirst()) ? &m_io.out : nullptr,
+        parser.isSet(progress_option.names().constFirst()) ? &m_io.err : nullptr
     ));
 }
 
@@ -935,6 +1358,12 @@ std::unique_ptr<Application> AppRunner::parseUnpackGrid() const
         QObject::tr("Texture filename"),
         QObject::tr("filename")
     };
+    const QCommandLineOption atlas_option
+    {
+        QStringList { "at", "atlas" },
+        QObject::tr("Atlas filename, the texture and the grid saved with the atlas are used by default"),
+        QObject::tr("filename")
+    };
     const QCommandLineOption output_option
     {
         QStringList { "out" },
@@ -1000,6 +1429,7 @@ std::unique_ptr<Application> AppRunner::parseUnpackGrid() const
     {
         m_help_options,
         texture_option,
+        atlas_option,
         output_option,
         format_option,
         rows_option,
@@ -1033,6 +1463,20 @@ std::unique_ptr<Application> AppRunner::parseUnpackGrid() const
     QString out_directory;
     QString format = "png";
 
+    if(parser.isSet(atlas_option.names().constFirst()))
+    {
+        const QString atlas_filename = parser.value(atlas_option.names().constFirst());
+        Atlas atlas;
+        Sol2dAtlasSerializer serializer;
+        serializer.deserialize(atlas_filename, atlas);
+        if(!atlas.grid)
+        {
+            m_io.err << QObject::tr("The atlas has no grid") << ": " << atlas_filename << Qt::endl;
+            return noop(ExitCodes::InvalidArgumentValue);
+        }
+        texture = atlas.texture;
+        grid_options = *atlas.grid;
+    }
     if(parser.isSet(texture_option.names().constFirst()))
         texture = parser.value(texture_option.names().constFirst());
     if(parser.isSet(output_option.names().constFirst()))
@@ -1150,6 +1594,8 @@ QStringList args = m_args;
 
 } // namespace
 
+Q_IMPORT_PLUGIN(QoiImageIOPlugin)
+
 int main(int _argc, char * _argv[])
 {
     QCoreApplication app(_argc, _argv);
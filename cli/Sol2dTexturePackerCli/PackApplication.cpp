@@ -17,6 +17,9 @@
  **********************************************************************************************************/
 
 #include <Sol2dTexturePackerCli/PackApplication.h>
+#include <LibSol2dTexturePacker/Packers/AtlasScaling.h>
+#include <QJsonDocument>
+#include <QElapsedTimer>
 
 PackApplication::PackApplication(
     QList<Sprite> && _sprites,
@@ -25,7 +28,12 @@ PackApplication::PackApplication(
     const QDir & _output_directory,
     const QString & _atlas_name,
     const QString & _texture_format,
-    const QString & _color_to_alpha
+    const QString & _color_to_alpha,
+    const TextureOptions & _texture_options,
+    const QList<int> & _scales,
+    const PackPhaseTime & _decode_time,
+    QTextStream * _statistics_stream,
+    QTextStream * _progress_stream
 ) :
     m_sprites(std::move(_sprites)),
     m_packer(std::move(_packer)),
@@ -33,14 +41,72 @@ PackApplication::PackApplication(
     m_output_directory(_output_directory),
     m_atlas_name(_atlas_name),
     m_texture_format(_texture_format),
-    m_color_to_alpha(_color_to_alpha)
+    m_color_to_alpha(_color_to_alpha),
+    m_texture_options(_texture_options),
+    m_scales(_scales),
+    m_decode_time(_decode_time),
+    m_statistics_stream(_statistics_stream),
+    m_progress_stream(_progress_stream)
 {
 }
 
 int PackApplication::exec()
 {
     QPromise<void> promise;
-    std::unique_ptr<RawAtlasPack> pack = m_packer->pack(promise, m_sprites, m_options);
-    pack->save(m_output_directory, m_atlas_name, m_texture_format, m_color_to_alpha);
+    AtlasPackerContext context(promise);
+    QElapsedTimer progress_timer;
+    qint64 last_progress_report = -1;
+    if(m_progress_stream)
+    {
+        progress_timer.start();
+        context.setProgressCallback([&](int __value, int __maximum) {
+            const qint64 elapsed = progress_timer.elapsed();
+            // The terminal does not need more than ten updates per second
+            if(__maximum <= 0 || (__value < __maximum && last_progress_report >= 0 && elapsed - last_progress_report < 100))
+                return;
+            last_progress_report = elapsed;
+            *m_progress_stream << "\r" << QObject::tr("Packing") << ": " << 100LL * __value / __maximum << "%";
+            if(__value > 0 && __value < __maximum)
+            {
+                const qint64 remaining = elapsed * (__maximum - __value) / __value / 1000;
+                *m_progress_stream << ", " << QObject::tr("about %1 s left").arg(remaining);
+            }
+            // Pad over the tail of a longer previous line
+            *m_progress_stream << "    " << Qt::flush;
+        });
+    }
+    std::unique_ptr<RawAtlasPack> pack = m_packer->pack(context, m_sprites, m_options);
+    if(m_progress_stream)
+        *m_progress_stream << Qt::endl;
+    if(m_scales.isEmpty())
+    {
+        pack->save(m_output_directory, m_atlas_name, m_texture_format, m_color_to_alpha, m_texture_options);
+    }
+    else
+    {
+        // The layout is packed at the largest scale, the smaller ones are divided from it
+        const int max_scale = m_scales.last();
+        PackStatistics scaled_statistics;
+        for(int scale : m_scales)
+        {
+            const QString atlas_name = scaledAtlasName(m_atlas_name, scale);
+            if(scale == max_scale)
+            {
+                pack->save(m_output_directory, atlas_name, m_texture_format, m_color_to_alpha, m_texture_options);
+                continue;
+            }
+            std::unique_ptr<RawAtlasPack> scaled_pack = downscaleAtlasPack(*pack, max_scale / scale);
+            scaled_pack->save(m_output_directory, atlas_name, m_texture_format, m_color_to_alpha, m_texture_options);
+            scaled_statistics.addPhases(scaled_pack->statistics());
+            scaled_statistics.bytes_written += scaled_pack->statistics().bytes_written;
+        }
+        pack->statistics().addPhases(scaled_statistics);
+        pack->statistics().bytes_written += scaled_statistics.bytes_written;
+    }
+    if(m_statistics_stream)
+    {
+        pack->statistics().phase(PackPhase::Decode) = m_decode_time;
+        *m_statistics_stream << QJsonDocument(pack->statistics().toJson()).toJson() << Qt::flush;
+    }
     return 0;
 }
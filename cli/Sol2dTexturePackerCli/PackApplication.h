@@ -19,7 +19,9 @@
 #pragma once
 
 #include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/TextureQuantizer.h>
 #include <Sol2dTexturePackerCli/Application.h>
+#include <QTextStream>
 
 class PackApplication : public Application
 {
@@ -33,7 +35,12 @@ public:
         const QDir & _output_directory,
         const QString & _atlas_name,
         const QString & _texture_format,
-        const QString & _color_to_alpha);
+        const QString & _color_to_alpha,
+        const TextureOptions & _texture_options,
+        const QList<int> & _scales,
+        const PackPhaseTime & _decode_time,
+        QTextStream * _statistics_stream,
+        QTextStream * _progress_stream);
     int exec() override;
 
 private:
@@ -44,4 +51,10 @@ private:
     const QString m_atlas_name;
     const QString m_texture_format;
     const QString m_color_to_alpha;
+    const TextureOptions m_texture_options;
+    // In ascending order, an atlas is written for every scale, or a single one without a suffix when the list is empty
+    const QList<int> m_scales;
+    const PackPhaseTime m_decode_time;
+    QTextStream * m_statistics_stream;
+    QTextStream * m_progress_stream;
 };
@@ -19,10 +19,49 @@
 #include <Sol2dTexturePackerGui/BusyDialog.h>
 #include <QCloseEvent>
 
+namespace {
+
+QString formatRemainingTime(qint64 _ms)
+{
+    const qint64 seconds = (_ms + 999) / 1000;
+    if(seconds < 60)
+        return BusyDialog::tr("%1 s").arg(seconds);
+    return BusyDialog::tr("%1 min %2 s").arg(seconds / 60).arg(seconds % 60);
+}
+
+} // namespace
+
 BusyDialog::BusyDialog(QWidget * _parent) :
     QProgressDialog(tr("Calculating..."), QString(), 0, 0, _parent, Qt::Dialog | Qt::FramelessWindowHint)
 {
     setModal(true);
+    setAutoReset(false);
+    setAutoClose(false);
+    m_elapsed_timer.start();
+}
+
+void BusyDialog::setProgressRange(int _minimum, int _maximum)
+{
+    setRange(_minimum, _maximum);
+}
+
+void BusyDialog::setProgressValue(int _value)
+{
+    setValue(_value);
+    const int done = _value - minimum();
+    const int total = maximum() - minimum();
+    if(total <= 0 || done <= 0)
+        return;
+    const qint64 elapsed = m_elapsed_timer.elapsed();
+    const int percent = static_cast<int>(100LL * done / total);
+    // The estimate is too noisy during the first second
+    if(elapsed < 1000)
+    {
+        setLabelText(tr("Calculating... %1%").arg(percent));
+        return;
+    }
+    const qint64 remaining = elapsed * (total - done) / done;
+    setLabelText(tr("Calculating... %1%\nAbout %2 left").arg(percent).arg(formatRemainingTime(remaining)));
 }
 
 void BusyDialog::closeEvent(QCloseEvent * _event)
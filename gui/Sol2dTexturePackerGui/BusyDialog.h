@@ -19,6 +19,7 @@
 #pragma once
 
 #include <QProgressDialog>
+#include <QElapsedTimer>
 
 class BusyDialog : public QProgressDialog
 {
@@ -26,7 +27,12 @@ class BusyDialog : public QProgressDialog
 
 public:
     explicit BusyDialog(QWidget * _parent = nullptr);
+    void setProgressRange(int _minimum, int _maximum);
+    void setProgressValue(int _value);
 
 protected:
     void closeEvent(QCloseEvent * _event) override;
+
+private:
+    QElapsedTimer m_elapsed_timer;
 };
@@ -20,48 +20,129 @@
 #include <Sol2dTexturePackerGui/BusyDialog.h>
 #include <LibSol2dTexturePacker/Exception.h>
 #include <QtConcurrentRun>
+#include <QFutureWatcher>
 
 BusySmartThread::BusySmartThread(QWidget * _parent_widget) :
     QObject(_parent_widget),
     m_spinner_display_timeout(400),
-    m_parent_widget(_parent_widget)
+    m_parent_widget(_parent_widget),
+    m_dialog(nullptr),
+    m_generation(0),
+    m_overlaps_abandoned_jobs(false)
 {
     m_timer = new QTimer(this);
     m_timer->setSingleShot(true);
 }
 
+BusySmartThread::~BusySmartThread()
+{
+    // Jobs may reference the parent widget, so they must not outlive it
+    abandonCurrentJob();
+    for(QFuture<void> & future : m_abandoned_futures)
+        future.waitForFinished();
+}
+
 void BusySmartThread::setSpinnerDisplayTimeout(uint32_t _timeout_ms)
 {
     m_spinner_display_timeout = _timeout_ms;
 }
 
-void BusySmartThread::start(std::function<void(QPromise<void> &)> _lambda)
+void BusySmartThread::start(Job _job, Completion _completion)
 {
-    BusyDialog * dialog = new BusyDialog(m_parent_widget);
-    connect(m_timer, &QTimer::timeout, dialog, &BusyDialog::show);
+    abandonCurrentJob();
+    // Finished jobs have just been dropped from the list
+    m_overlaps_abandoned_jobs = !m_abandoned_futures.isEmpty();
+    const quint64 generation = ++m_generation;
+    m_dialog = new BusyDialog(m_parent_widget);
+    connect(m_timer, &QTimer::timeout, m_dialog, &BusyDialog::show);
     m_timer->setInterval(m_spinner_display_timeout);
     m_timer->start();
-    if(m_future.isRunning())
-    {
-        m_future.cancel();
-        m_future.waitForFinished();
-    }
-    m_future = QtConcurrent::run([_lambda, dialog, this](QPromise<void> & __promise) {
+    m_future = QtConcurrent::run([_job, _completion, generation, this](QPromise<void> & __promise) {
+        bool is_succeeded = false;
+        QString error_message;
+        const Publisher publisher = [this, generation](Completion __completion) {
+            QMetaObject::invokeMethod(this, [this, generation, __completion]() {
+                publishResult(generation, __completion);
+            }, Qt::QueuedConnection);
+        };
         try
         {
-            _lambda(__promise);
-            emit success();
+            _job(__promise, publisher);
+            is_succeeded = true;
         }
         catch(const Exception & error)
         {
-            emit failed(error.message());
+            error_message = error.message();
         }
         catch(...)
         {
-            emit failed(tr("An unknown error has occurred"));
+            error_message = tr("An unknown error has occurred");
         }
-        dialog->deleteLater();
-        m_timer->stop();
-        emit complete();
+        QMetaObject::invokeMethod(this, [this, generation, is_succeeded, error_message, _completion]() {
+            finishJob(generation, is_succeeded, error_message, _completion);
+        }, Qt::QueuedConnection);
     });
+    QFutureWatcher<void> * watcher = new QFutureWatcher<void>(m_dialog);
+    connect(watcher, &QFutureWatcher<void>::progressRangeChanged, m_dialog, &BusyDialog::setProgressRange);
+    connect(watcher, &QFutureWatcher<void>::progressValueChanged, m_dialog, &BusyDialog::setProgressValue);
+    watcher->setFuture(m_future);
+}
+
+void BusySmartThread::abandonCurrentJob()
+{
+    m_abandoned_futures.removeIf([](const QFuture<void> & __future) { return __future.isFinished(); });
+    if(!m_future.isFinished())
+    {
+        // The job notices the cancellation at its next check, its result is discarded by the generation check
+        m_future.cancel();
+        m_abandoned_futures.append(m_future);
+    }
+    m_future = QFuture<void>();
+    if(m_dialog)
+    {
+        m_timer->stop();
+        m_dialog->deleteLater();
+        m_dialog = nullptr;
+    }
+}
+
+void BusySmartThread::publishResult(quint64 _generation, const Completion & _completion)
+{
+    if(_generation != m_generation)
+        return;
+    // The first result is shown instead of the busy dialog, the job keeps improving it in the background
+    m_timer->stop();
+    if(m_dialog)
+    {
+        m_dialog->deleteLater();
+        m_dialog = nullptr;
+    }
+    _completion();
+}
+
+void BusySmartThread::finishJob(
+    quint64 _generation,
+    bool _is_succeeded,
+    const QString & _error_message,
+    const Completion & _completion)
+{
+    if(_generation != m_generation)
+        return;
+    m_timer->stop();
+    if(m_dialog)
+    {
+        m_dialog->deleteLater();
+        m_dialog = nullptr;
+    }
+    if(_is_succeeded)
+    {
+        if(_completion)
+            _completion();
+        emit success();
+    }
+    else
+    {
+        emit failed(_error_message);
+    }
+    emit complete();
 }
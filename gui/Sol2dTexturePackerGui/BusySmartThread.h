@@ -20,24 +20,48 @@
 
 #include <QTimer>
 #include <QFuture>
+#include <QPromise>
+#include <functional>
+
+class BusyDialog;
 
 class BusySmartThread : public QObject
 {
     Q_OBJECT
 
+public:
+    typedef std::function<void()> Completion;
+    // Hands an intermediate result over to the GUI thread, thread-safe
+    typedef std::function<void(Completion)> Publisher;
+    typedef std::function<void(QPromise<void> &, const Publisher &)> Job;
+
 public:
     explicit BusySmartThread(QWidget * _parent_widget);
+    ~BusySmartThread() override;
     void setSpinnerDisplayTimeout(uint32_t _timeout_ms);
-    void start(std::function<void(QPromise<void> &)> _lambda);
+    // The job runs in a pool thread. The completion runs in the GUI thread
+    // after a successful job, unless the job has been superseded by a newer one.
+    void start(Job _job, Completion _completion = nullptr);
+    // Abandoned jobs were still running when the current job started, so they share the process with it
+    bool overlapsAbandonedJobs() const { return m_overlaps_abandoned_jobs; }
 
 signals:
     void failed(QString _message);
     void success();
     void complete();
 
+private:
+    void abandonCurrentJob();
+    void publishResult(quint64 _generation, const Completion & _completion);
+    void finishJob(quint64 _generation, bool _is_succeeded, const QString & _error_message, const Completion & _completion);
+
 private:
     uint32_t m_spinner_display_timeout;
     QWidget * m_parent_widget;
     QTimer * m_timer;
+    BusyDialog * m_dialog;
+    quint64 m_generation;
     QFuture<void> m_future;
+    QList<QFuture<void>> m_abandoned_futures;
+    bool m_overlaps_abandoned_jobs;
 };
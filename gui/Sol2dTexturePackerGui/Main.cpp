@@ -20,6 +20,9 @@
 #include <Sol2dTexturePackerGui/MainWindow.h>
 #include <LibSol2dTexturePacker/Frame.h>
 #include <LibSol2dTexturePacker/Sprite.h>
+#include <QtPlugin>
+
+Q_IMPORT_PLUGIN(QoiImageIOPlugin)
 
 int main(int _argc, char * _argv[])
 {
@@ -43,22 +43,16 @@ enum class PackAlgorithm
     Meta
 };
 
-} // namespace name
-
-struct SpritePackerWidget::Packers
+QString formatMilliseconds(qint64 _ns)
 {
-    MaxRectsBinAtlasPacker max_rects_bin;
-    SkylineBinAtlasPacker skyline_bin;
-    GuillotineBinAtlaskPacker guillotine_bin;
-    ShelfBinAtlasPacker shelf_bin;
-    MetaAtlasPacker meta;
-    AtlasPacker * current;
-};
+    return QString::number(static_cast<double>(_ns) / 1000000.0, 'f', 2);
+}
 
+} // namespace name
 
 SpritePackerWidget::SpritePackerWidget(QWidget * _parent) :
     QWidget(_parent),
-    m_packers(new Packers),
+    m_meta_time_budget(0),
     m_last_calulated_size(2048, 2048)
 {
     setupUi(this);
@@ -66,8 +60,6 @@ SpritePackerWidget::SpritePackerWidget(QWidget * _parent) :
     QSettings settings;
 
     m_thread = new BusySmartThread(this);
-    m_packers->current = nullptr;
-    m_packers->max_rects_bin.setChoiceHeuristic(MaxRectsBinAtlasPackerChoiceHeuristic::BestAreaFit);
 
     m_spin_max_width->setValue(m_last_calulated_size.width());
     m_spin_max_height->setValue(m_last_calulated_size.height());
@@ -166,17 +158,34 @@ SpritePackerWidget::SpritePackerWidget(QWidget * _parent) :
         tr("Worst Width Fit"),
         static_cast<int>(ShelfBinAtlasPackerChoiceHeuristic::WorstWidthFit));
 
-    {
-        QList<QByteArray> supported_image_formats = QImageWriter::supportedImageFormats();
-        int png_idx = -1;
-        for(int i = 0; i < supported_image_formats.count(); ++i)
-        {
-            QString format(supported_image_formats[i]);
-            m_combo_texture_format->addItem(format);
-            if(format == "png") png_idx = i;
-        }
-        m_combo_texture_format->setCurrentIndex(png_idx);
-    }
+    m_combo_meta_cost_model->addItem(
+        tr("Total Area"),
+        static_cast<int>(AtlasPackCostModelType::TotalArea));
+    m_combo_meta_cost_model->addItem(
+        tr("Atlas Count"),
+        static_cast<int>(AtlasPackCostModelType::AtlasCountThenArea));
+    m_combo_meta_cost_model->addItem(
+        tr("Video Memory"),
+        static_cast<int>(AtlasPackCostModelType::VideoMemory));
+    m_combo_meta_cost_model->addItem(
+        tr("File Size"),
+        static_cast<int>(AtlasPackCostModelType::CompressedSize));
+
+    m_combo_pixel_format->addItem(tr("RGBA 8888"), static_cast<int>(TexturePixelFormat::RGBA8888));
+    m_combo_pixel_format->addItem(tr("RGB 888"), static_cast<int>(TexturePixelFormat::RGB888));
+    m_combo_pixel_format->addItem(tr("RGBA 4444"), static_cast<int>(TexturePixelFormat::RGBA4444));
+    m_combo_pixel_format->addItem(tr("RGB 565"), static_cast<int>(TexturePixelFormat::RGB565));
+    m_combo_pixel_format->addItem(tr("RGBA 5551"), static_cast<int>(TexturePixelFormat::RGBA5551));
+    m_combo_pixel_format->addItem(tr("Alpha 8"), static_cast<int>(TexturePixelFormat::A8));
+    m_combo_pixel_format->addItem(tr("Luminance 8"), static_cast<int>(TexturePixelFormat::L8));
+    m_combo_pixel_format->addItem(tr("Indexed 8"), static_cast<int>(TexturePixelFormat::Indexed8));
+    m_combo_dithering->addItem(tr("None"), static_cast<int>(TextureDithering::None));
+    m_combo_dithering->addItem(tr("Ordered"), static_cast<int>(TextureDithering::Ordered));
+    m_combo_dithering->addItem(tr("Floyd-Steinberg"), static_cast<int>(TextureDithering::FloydSteinberg));
+    m_combo_compression->addItem(tr("None"), static_cast<int>(TextureCompression::None));
+    m_combo_compression->addItem(tr("BC1 (DXT1)"), static_cast<int>(TextureCompression::BC1));
+    m_combo_compression->addItem(tr("BC3 (DXT5)"), static_cast<int>(TextureCompression::BC3));
+    fillTextureFormats();
 
     QTimer::singleShot(100, this, [this]() {
         emit packNameChanged(m_edit_export_name->text());
@@ -187,10 +196,16 @@ SpritePackerWidget::SpritePackerWidget(QWidget * _parent) :
     connect(m_widget_sprite_list, &SpriteListWidget::spriteListChanged, this, &SpritePackerWidget::renderPack);
     connect(m_checkbox_color_to_alpha, &QCheckBox::checkStateChanged, this, &SpritePackerWidget::onColorToAlphaToggle);
     connect(m_btn_pick_color_to_alpha, &QPushButton::clicked, this, &SpritePackerWidget::pickColorToAlpha);
+    connect(m_edit_color_to_alpha, &QLineEdit::editingFinished, this, &SpritePackerWidget::renderPack);
+    connect(m_groupbox_statistics, &QGroupBox::toggled, m_label_statistics, &QLabel::setVisible);
     connect(m_checkbox_crop, &QCheckBox::checkStateChanged, this, &SpritePackerWidget::renderPack);
     connect(m_checkbox_detect_duplicates, &QCheckBox::checkStateChanged, this, &SpritePackerWidget::renderPack);
+    connect(m_checkbox_detect_duplicates, &QCheckBox::toggled, m_checkbox_detect_transformed_duplicates, &QWidget::setEnabled);
+    connect(m_checkbox_detect_transformed_duplicates, &QCheckBox::checkStateChanged, this, &SpritePackerWidget::renderPack);
+    connect(m_checkbox_premultiply_alpha, &QCheckBox::checkStateChanged, this, &SpritePackerWidget::renderPack);
     connect(m_spin_max_width, &QSpinBox::editingFinished, this, &SpritePackerWidget::onTextureWidthChanged);
     connect(m_spin_max_height, &QSpinBox::editingFinished, this, &SpritePackerWidget::onTextureHeightChanged);
+    connect(m_combo_compression, &QComboBox::currentIndexChanged, this, &SpritePackerWidget::onCompressionChanged);
     connect(m_btn_export, &QPushButton::clicked, this, &SpritePackerWidget::exportPack);
     connect(m_btn_browse_export_directory, &QPushButton::clicked, this, &SpritePackerWidget::browseForExportDir);
     connect(m_edit_export_directory, &QLineEdit::textChanged, this, &SpritePackerWidget::validateExportPackRequirements);
@@ -200,12 +215,12 @@ SpritePackerWidget::SpritePackerWidget(QWidget * _parent) :
         m_checkbox_mrb_allow_flip,
         &QCheckBox::checkStateChanged,
         this,
-        &SpritePackerWidget::onMaxRectesBiAllowFlipChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_combo_mrb_heuristic,
         &QComboBox::currentIndexChanged,
         this,
-        &SpritePackerWidget::onMaxRectesBinHeuristicChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_combo_algorithm,
         &QComboBox::currentIndexChanged,
@@ -215,52 +230,51 @@ SpritePackerWidget::SpritePackerWidget(QWidget * _parent) :
         m_combo_skyline_heuristic,
         &QComboBox::currentIndexChanged,
         this,
-        &SpritePackerWidget::onSkylineBinHeuristicChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_checkbox_skyline_use_waste_map,
         &QCheckBox::checkStateChanged,
         this,
-        &SpritePackerWidget::onSkylineBinUseWasteMapChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_combo_guillotine_choice_heuristic,
         &QComboBox::currentIndexChanged,
         this,
-        &SpritePackerWidget::onGuillotineBinChoiceHeuristicChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_combo_guillotine_split_heuristic,
         &QComboBox::currentIndexChanged,
         this,
-        &SpritePackerWidget::onGuillotineBinSplitHeuristicChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_checkbox_guillotine_allow_merge,
         &QCheckBox::checkStateChanged,
         this,
-        &SpritePackerWidget::onGuillotineBinAllowMergeChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_combo_shelf_choice_heuristic,
         &QComboBox::currentIndexChanged,
         this,
-        &SpritePackerWidget::onShelfBinSplitHeuristicChanged);
+        &SpritePackerWidget::renderPack);
     connect(
         m_checkbox_shelf_use_waste_map,
         &QCheckBox::checkStateChanged,
         this,
-        &SpritePackerWidget::onShelfBinUseWasteMapChanged);
-
-    m_packers->max_rects_bin.setChoiceHeuristic(
-        static_cast<MaxRectsBinAtlasPackerChoiceHeuristic>(m_combo_mrb_heuristic->currentData().toInt()));
-    m_packers->max_rects_bin.allowFlip(m_checkbox_mrb_allow_flip->isChecked());
-    m_packers->skyline_bin.setLevelChoiceHeuristic(
-        static_cast<SkylineBinAtlasPackerLevelChoiceHeuristic>(m_combo_skyline_heuristic->currentData().toInt()));
-    m_packers->skyline_bin.enableWasteMap(m_checkbox_skyline_use_waste_map->isChecked());
-    m_packers->guillotine_bin.setChoiceHeuristic(
-        static_cast<GuillotineBinAtlasPackerChoiceHeuristic>(m_combo_guillotine_choice_heuristic->currentData().toInt()));
-    m_packers->guillotine_bin.setSplitHeuristic(
-        static_cast<GuillotineBinAtlasPackerSplitHeuristic>(m_combo_guillotine_split_heuristic->currentData().toInt()));
-    m_packers->guillotine_bin.enableMerge(m_checkbox_guillotine_allow_merge->isChecked());
-    m_packers->shelf_bin.setChoiceHeuristic(
-        static_cast<ShelfBinAtlasPackerChoiceHeuristic>(m_combo_shelf_choice_heuristic->currentData().toInt()));
-    m_packers->shelf_bin.enableWasteMap(m_checkbox_shelf_use_waste_map->isChecked());
+        &SpritePackerWidget::renderPack);
+    connect(
+        m_combo_meta_cost_model,
+        &QComboBox::currentIndexChanged,
+        this,
+        &SpritePackerWidget::renderPack);
+    connect(
+        m_spin_meta_time_budget,
+        &QSpinBox::editingFinished,
+        this,
+        &SpritePackerWidget::onMetaTimeBudgetChanged);
+
+    m_meta_time_budget = m_spin_meta_time_budget->value() * 1000;
+
+    m_label_statistics->setVisible(m_groupbox_statistics->isChecked());
 
     onColorToAlphaToggle();
     onAlgorithmChanged();
@@ -272,13 +286,15 @@ SpritePackerWidget::~SpritePackerWidget()
     QSettings settings;
     settings.setValue(Settings::Geometry::packer_splitter, m_splitter->saveGeometry());
     settings.setValue(Settings::State::packer_splitter, m_splitter->saveState());
-    delete m_packers;
+    // Waits for abandoned jobs that may still publish their results here
+    delete m_thread;
 }
 
 void SpritePackerWidget::onColorToAlphaToggle()
 {
     m_edit_color_to_alpha->setEnabled(m_checkbox_color_to_alpha->isChecked());
     m_btn_pick_color_to_alpha->setEnabled(m_checkbox_color_to_alpha->isChecked());
+    renderPack();
 }
 
 void SpritePackerWidget::pickColorToAlpha()
@@ -295,33 +311,123 @@ void SpritePackerWidget::pickColorToAlpha()
             .arg(color.red(), 2, 16, '0')
             .arg(color.green(), 2, 16, '0')
             .arg(color.blue(), 2, 16, '0'));
+        renderPack();
+    }
+}
+
+std::unique_ptr<AtlasPacker> SpritePackerWidget::createPacker() const
+{
+    switch(static_cast<PackAlgorithm>(m_combo_algorithm->currentData().toInt()))
+    {
+    case PackAlgorithm::MaxRectsBin:
+    {
+        std::unique_ptr<MaxRectsBinAtlasPacker> packer = std::make_unique<MaxRectsBinAtlasPacker>();
+        packer->setChoiceHeuristic(
+            static_cast<MaxRectsBinAtlasPackerChoiceHeuristic>(m_combo_mrb_heuristic->currentData().toInt()));
+        packer->allowFlip(m_checkbox_mrb_allow_flip->isChecked());
+        return packer;
+    }
+    case PackAlgorithm::SkylineBinPack:
+    {
+        std::unique_ptr<SkylineBinAtlasPacker> packer = std::make_unique<SkylineBinAtlasPacker>();
+        packer->setLevelChoiceHeuristic(
+            static_cast<SkylineBinAtlasPackerLevelChoiceHeuristic>(m_combo_skyline_heuristic->currentData().toInt()));
+        packer->enableWasteMap(m_checkbox_skyline_use_waste_map->isChecked());
+        return packer;
+    }
+    case PackAlgorithm::GuillotineBinPack:
+    {
+        std::unique_ptr<GuillotineBinAtlaskPacker> packer = std::make_unique<GuillotineBinAtlaskPacker>();
+        packer->setChoiceHeuristic(
+            static_cast<GuillotineBinAtlasPackerChoiceHeuristic>(m_combo_guillotine_choice_heuristic->currentData().toInt()));
+        packer->setSplitHeuristic(
+            static_cast<GuillotineBinAtlasPackerSplitHeuristic>(m_combo_guillotine_split_heuristic->currentData().toInt()));
+        packer->enableMerge(m_checkbox_guillotine_allow_merge->isChecked());
+        return packer;
+    }
+    case PackAlgorithm::ShelfBinPack:
+    {
+        std::unique_ptr<ShelfBinAtlasPacker> packer = std::make_unique<ShelfBinAtlasPacker>();
+        packer->setChoiceHeuristic(
+            static_cast<ShelfBinAtlasPackerChoiceHeuristic>(m_combo_shelf_choice_heuristic->currentData().toInt()));
+        packer->enableWasteMap(m_checkbox_shelf_use_waste_map->isChecked());
+        return packer;
+    }
+    case PackAlgorithm::Meta:
+    {
+        std::unique_ptr<MetaAtlasPacker> packer = std::make_unique<MetaAtlasPacker>();
+        packer->setCostModel(AtlasPackCostModel::create(
+            static_cast<AtlasPackCostModelType>(m_combo_meta_cost_model->currentData().toInt())));
+        packer->setTimeBudget(m_meta_time_budget);
+        return packer;
+    }
+    default:
+        return nullptr;
     }
 }
 
+std::optional<QRgb> SpritePackerWidget::colorToAlpha() const
+{
+    if(!m_checkbox_color_to_alpha->isChecked())
+        return std::nullopt;
+    const QColor color = QColor::fromString(m_edit_color_to_alpha->text());
+    if(!color.isValid())
+        return std::nullopt;
+    return color.rgb();
+}
+
 void SpritePackerWidget::renderPack()
 {
     if(m_widget_sprite_list->sprites().isEmpty())
         return;
-    m_thread->start([this](QPromise<void> & __promise) {
-        QList<Sprite> sprites_snapshot = m_widget_sprite_list->sprites();
-        m_atlases = m_packers->current->pack(
-            __promise,
-            sprites_snapshot,
-            {
-                .max_atlas_size = QSize(
-                    m_spin_max_width->value(),
-                    m_spin_max_height->value()
-                    ),
-                .detect_duplicates = m_checkbox_detect_duplicates->isChecked(),
-                .crop = m_checkbox_crop->isChecked(),
-                .remove_file_extensions = m_checkbox_remove_file_ext->isChecked()
+    // Widgets are read here, in the GUI thread, the job works with the snapshots only.
+    // Every job gets a packer of its own, abandoned jobs keep theirs until they stop.
+    const QList<Sprite> sprites_snapshot = m_widget_sprite_list->sprites();
+    const AtlasPackerOptions options
+    {
+        .max_atlas_size = QSize(
+            m_spin_max_width->value(),
+            m_spin_max_height->value()
+            ),
+        .detect_duplicates = m_checkbox_detect_duplicates->isChecked(),
+        .detect_transformed_duplicates = m_checkbox_detect_transformed_duplicates->isChecked(),
+        .crop = m_checkbox_crop->isChecked(),
+        .color_to_alpha = colorToAlpha(),
+        .remove_file_extensions = m_checkbox_remove_file_ext->isChecked(),
+        .premultiply_alpha = m_checkbox_premultiply_alpha->isChecked(),
+        .block_size = m_combo_compression->currentData().toInt() == static_cast<int>(TextureCompression::None)
+            ? 1
+            : g_texture_compression_block_size
+    };
+    const std::shared_ptr<const AtlasPacker> packer = createPacker();
+    if(packer == nullptr)
+        return;
+    std::shared_ptr<std::unique_ptr<RawAtlasPack>> result = std::make_shared<std::unique_ptr<RawAtlasPack>>();
+    m_thread->start(
+        [this, packer, sprites_snapshot, options, result](
+            QPromise<void> & __promise,
+            const BusySmartThread::Publisher & __publish)
+        {
+            AtlasPackerContext context(__promise);
+            context.setResultCallback([this, &__publish](const RawAtlasPack & __pack) {
+                std::shared_ptr<std::unique_ptr<RawAtlasPack>> intermediate =
+                    std::make_shared<std::unique_ptr<RawAtlasPack>>(__pack.clone());
+                __publish([this, intermediate]() {
+                    m_atlases = std::move(*intermediate);
+                    onRenderPackFinished();
+                });
             });
-    });
+            *result = packer->pack(context, sprites_snapshot, options);
+        },
+        [this, result]() {
+            m_atlases = std::move(*result);
+        });
 }
 
 void SpritePackerWidget::onRenderPackFinished()
 {
     m_preview->scene()->clear();
+    updateStatistics();
     if(m_atlases == nullptr)
         return;
     const qreal y_gap = 100.0;
@@ -375,7 +481,16 @@ void SpritePackerWidget::exportPack()
             m_edit_export_directory->text(),
             m_edit_export_name->text(),
             m_combo_texture_format->currentText(),
-            m_edit_color_to_alpha->text());
+            // The color is applied when the atlas is rendered
+            QString(),
+            TextureOptions
+            {
+                .pixel_format = static_cast<TexturePixelFormat>(m_combo_pixel_format->currentData().toInt()),
+                .dithering = static_cast<TextureDithering>(m_combo_dithering->currentData().toInt()),
+                .compression = static_cast<TextureCompression>(m_combo_compression->currentData().toInt()),
+                .strip_opaque_alpha = m_checkbox_strip_opaque_alpha->isChecked()
+            });
+        updateStatistics();
         QMessageBox::information(this, QString(), tr("Atlas export completed successfully"));
     }
     catch(const Exception & _exception)
@@ -384,6 +499,78 @@ void SpritePackerWidget::exportPack()
     }
 }
 
+void SpritePackerWidget::onCompressionChanged()
+{
+    fillTextureFormats();
+    // Compressed textures need the sprites aligned to the blocks
+    renderPack();
+}
+
+void SpritePackerWidget::fillTextureFormats()
+{
+    QStringList formats;
+    QString default_format;
+    if(m_combo_compression->currentData().toInt() == static_cast<int>(TextureCompression::None))
+    {
+        for(const QByteArray & format : QImageWriter::supportedImageFormats())
+            formats.append(QString(format));
+        default_format = "png";
+    }
+    else
+    {
+        formats = { "dds", "ktx2" };
+        default_format = "ktx2";
+    }
+    m_combo_texture_format->clear();
+    m_combo_texture_format->addItems(formats);
+    m_combo_texture_format->setCurrentIndex(static_cast<int>(formats.indexOf(default_format)));
+}
+
+void SpritePackerWidget::updateStatistics()
+{
+    if(m_atlases == nullptr)
+    {
+        m_label_statistics->clear();
+        return;
+    }
+    const PackStatistics & statistics = m_atlases->statistics();
+    QStringList occupancy;
+    for(double value : statistics.occupancy)
+        occupancy.append(QString("%1%").arg(value * 100.0, 0, 'f', 1));
+    QStringList lines
+    {
+        tr("Sprites: %1 (duplicates: %2)").arg(statistics.sprite_count).arg(statistics.duplicate_count),
+        tr("Atlases: %1 (occupancy: %2)").arg(statistics.bin_count).arg(occupancy.join(", "))
+    };
+    if(statistics.trial_count > 0)
+    {
+        lines.append(tr("Configurations tried: %1 (pruned: %2)")
+            .arg(statistics.trial_count)
+            .arg(statistics.pruned_trial_count));
+    }
+    // The CPU time is measured for the whole process, abandoned jobs that kept running would inflate it
+    const bool is_cpu_time_valid = !m_thread->overlapsAbandonedJobs();
+    for(int i = 0; i < PackStatistics::phase_count; ++i)
+    {
+        const PackPhase phase = static_cast<PackPhase>(i);
+        const PackPhaseTime & time = statistics.phase(phase);
+        if(time.wall_ns == 0)
+            continue;
+        if(is_cpu_time_valid)
+        {
+            lines.append(tr("%1: %2 ms (CPU %3 ms)")
+                .arg(PackStatistics::phaseName(phase), formatMilliseconds(time.wall_ns), formatMilliseconds(time.cpu_ns)));
+        }
+        else
+        {
+            lines.append(tr("%1: %2 ms").arg(PackStatistics::phaseName(phase), formatMilliseconds(time.wall_ns)));
+        }
+    }
+    if(statistics.bytes_written > 0)
+        lines.append(tr("Bytes written: %1").arg(statistics.bytes_written));
+    m_label_statistics->setText(lines.join('\n'));
+}
+
 void SpritePackerWidget::validateExportPackRequirements()
 {
     bool valid =
@@ -410,109 +597,40 @@ void SpritePackerWidget::browseForExportDir()
 
 void SpritePackerWidget::onAlgorithmChanged()
 {
-    AtlasPacker * new_packer;
-    switch(static_cast<PackAlgorithm>(m_combo_algorithm->currentData().toInt()))
-    {
-    case PackAlgorithm::MaxRectsBin:
-        new_packer = &m_packers->max_rects_bin;
-        break;
-    case PackAlgorithm::SkylineBinPack:
-        new_packer = &m_packers->skyline_bin;
-        break;
-    case PackAlgorithm::GuillotineBinPack:
-        new_packer = &m_packers->guillotine_bin;
-        break;
-    case PackAlgorithm::ShelfBinPack:
-        new_packer = &m_packers->shelf_bin;
-        break;
-    case PackAlgorithm::Meta:
-        new_packer = &m_packers->meta;
-        break;
-    default:
-        new_packer = m_packers->current;
-        break;
-    }
-    if(m_packers->current != new_packer)
-    {
-        m_label_mrb_heuristic->setVisible(new_packer == &m_packers->max_rects_bin);
-        m_combo_mrb_heuristic->setVisible(new_packer == &m_packers->max_rects_bin);
-        m_combo_mrb_heuristic->setVisible(new_packer == &m_packers->max_rects_bin);
-        m_checkbox_mrb_allow_flip->setVisible(new_packer == &m_packers->max_rects_bin);
-
-        m_label_skyline_heuristic->setVisible(new_packer == &m_packers->skyline_bin);
-        m_combo_skyline_heuristic->setVisible(new_packer == &m_packers->skyline_bin);
-        m_checkbox_skyline_use_waste_map->setVisible(new_packer == &m_packers->skyline_bin);
-
-        m_label_guillotine_choice_heuristic->setVisible(new_packer == &m_packers->guillotine_bin);
-        m_combo_guillotine_choice_heuristic->setVisible(new_packer == &m_packers->guillotine_bin);
-        m_label_guillotine_split_heuristic->setVisible(new_packer == &m_packers->guillotine_bin);
-        m_combo_guillotine_split_heuristic->setVisible(new_packer == &m_packers->guillotine_bin);
-        m_checkbox_guillotine_allow_merge->setVisible(new_packer == &m_packers->guillotine_bin);
-
-        m_label_shelf_choice_heuristic->setVisible(new_packer == &m_packers->shelf_bin);
-        m_combo_shelf_choice_heuristic->setVisible(new_packer == &m_packers->shelf_bin);
-        m_checkbox_shelf_use_waste_map->setVisible(new_packer == &m_packers->shelf_bin);
-
-        m_packers->current = new_packer;
-        renderPack();
-    }
-}
+    const PackAlgorithm algorithm = static_cast<PackAlgorithm>(m_combo_algorithm->currentData().toInt());
 
-void SpritePackerWidget::onMaxRectesBiAllowFlipChanged(Qt::CheckState _state)
-{
-    m_packers->max_rects_bin.allowFlip(_state == Qt::Checked);
-    renderPack();
-}
+    m_label_mrb_heuristic->setVisible(algorithm == PackAlgorithm::MaxRectsBin);
+    m_combo_mrb_heuristic->setVisible(algorithm == PackAlgorithm::MaxRectsBin);
+    m_checkbox_mrb_allow_flip->setVisible(algorithm == PackAlgorithm::MaxRectsBin);
 
-void SpritePackerWidget::onMaxRectesBinHeuristicChanged(int _index)
-{
-    int heuristic = m_combo_mrb_heuristic->itemData(_index).toInt();
-    m_packers->max_rects_bin.setChoiceHeuristic(static_cast<MaxRectsBinAtlasPackerChoiceHeuristic>(heuristic));
-    renderPack();
-}
+    m_label_skyline_heuristic->setVisible(algorithm == PackAlgorithm::SkylineBinPack);
+    m_combo_skyline_heuristic->setVisible(algorithm == PackAlgorithm::SkylineBinPack);
+    m_checkbox_skyline_use_waste_map->setVisible(algorithm == PackAlgorithm::SkylineBinPack);
 
-void SpritePackerWidget::onSkylineBinUseWasteMapChanged(Qt::CheckState _state)
-{
-    m_packers->skyline_bin.enableWasteMap(_state == Qt::Checked);
-    renderPack();
-}
+    m_label_guillotine_choice_heuristic->setVisible(algorithm == PackAlgorithm::GuillotineBinPack);
+    m_combo_guillotine_choice_heuristic->setVisible(algorithm == PackAlgorithm::GuillotineBinPack);
+    m_label_guillotine_split_heuristic->setVisible(algorithm == PackAlgorithm::GuillotineBinPack);
+    m_combo_guillotine_split_heuristic->setVisible(algorithm == PackAlgorithm::GuillotineBinPack);
+    m_checkbox_guillotine_allow_merge->setVisible(algorithm == PackAlgorithm::GuillotineBinPack);
 
-void SpritePackerWidget::onSkylineBinHeuristicChanged(int _index)
-{
-    int heuristic = m_combo_skyline_heuristic->itemData(_index).toInt();
-    m_packers->skyline_bin.setLevelChoiceHeuristic(static_cast<SkylineBinAtlasPackerLevelChoiceHeuristic>(heuristic));
-    renderPack();
-}
+    m_label_shelf_choice_heuristic->setVisible(algorithm == PackAlgorithm::ShelfBinPack);
+    m_combo_shelf_choice_heuristic->setVisible(algorithm == PackAlgorithm::ShelfBinPack);
+    m_checkbox_shelf_use_waste_map->setVisible(algorithm == PackAlgorithm::ShelfBinPack);
 
-void SpritePackerWidget::onGuillotineBinChoiceHeuristicChanged(int _index)
-{
-    int heuristic = m_combo_guillotine_choice_heuristic->itemData(_index).toInt();
-    m_packers->guillotine_bin.setChoiceHeuristic(static_cast<GuillotineBinAtlasPackerChoiceHeuristic>(heuristic));
-    renderPack();
-}
-
-void SpritePackerWidget::onGuillotineBinSplitHeuristicChanged(int _index)
-{
-    int heuristic = m_combo_guillotine_split_heuristic->itemData(_index).toInt();
-    m_packers->guillotine_bin.setSplitHeuristic(static_cast<GuillotineBinAtlasPackerSplitHeuristic>(heuristic));
-    renderPack();
-}
-
-void SpritePackerWidget::onGuillotineBinAllowMergeChanged(Qt::CheckState _state)
-{
-    m_packers->guillotine_bin.enableMerge(_state == Qt::Checked);
-    renderPack();
-}
+    m_label_meta_cost_model->setVisible(algorithm == PackAlgorithm::Meta);
+    m_combo_meta_cost_model->setVisible(algorithm == PackAlgorithm::Meta);
+    m_label_meta_time_budget->setVisible(algorithm == PackAlgorithm::Meta);
+    m_spin_meta_time_budget->setVisible(algorithm == PackAlgorithm::Meta);
 
-void SpritePackerWidget::onShelfBinSplitHeuristicChanged(int _index)
-{
-    int heuristic = m_combo_shelf_choice_heuristic->itemData(_index).toInt();
-    m_packers->shelf_bin.setChoiceHeuristic(static_cast<ShelfBinAtlasPackerChoiceHeuristic>(heuristic));
     renderPack();
 }
 
-void SpritePackerWidget::onShelfBinUseWasteMapChanged(Qt::CheckState _state)
+void SpritePackerWidget::onMetaTimeBudgetChanged()
 {
-    m_packers->shelf_bin.enableWasteMap(_state == Qt::Checked);
-    renderPack();
+    const qint64 budget = m_spin_meta_time_budget->value() * 1000;
+    if(m_meta_time_budget != budget)
+    {
+        m_meta_time_budget = budget;
+        renderPack();
+    }
 }
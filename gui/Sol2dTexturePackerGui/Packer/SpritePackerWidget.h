@@ -20,6 +20,7 @@
 
 #include "ui_SpritePackerWidget.h"
 #include <Sol2dTexturePackerGui/BusySmartThread.h>
+#include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
 #include <LibSol2dTexturePacker/Packers/RawAtlasPack.h>
 #include <memory>
 
@@ -28,7 +29,6 @@ class SpritePackerWidget : public QWidget, private Ui::SpritePackerWidget
     Q_OBJECT
 
 private:
-    struct Packers;
     class SpriteListModel;
 
 public:
@@ -50,18 +50,18 @@ private slots:
     void onTextureWidthChanged();
     void onTextureHeightChanged();
     void onAlgorithmChanged();
-    void onMaxRectesBiAllowFlipChanged(Qt::CheckState _state);
-    void onMaxRectesBinHeuristicChanged(int _index);
-    void onSkylineBinUseWasteMapChanged(Qt::CheckState _state);
-    void onSkylineBinHeuristicChanged(int _index);
-    void onGuillotineBinChoiceHeuristicChanged(int _index);
-    void onGuillotineBinSplitHeuristicChanged(int _index);
-    void onGuillotineBinAllowMergeChanged(Qt::CheckState _state);
-    void onShelfBinSplitHeuristicChanged(int _index);
-    void onShelfBinUseWasteMapChanged(Qt::CheckState _state);
+    void onMetaTimeBudgetChanged();
+    void onCompressionChanged();
 
 private:
-    Packers * m_packers;
+    void updateStatistics();
+    void fillTextureFormats();
+    std::optional<QRgb> colorToAlpha() const;
+    // A new packer set up from the widgets, jobs never share one with the GUI thread
+    std::unique_ptr<AtlasPacker> createPacker() const;
+
+private:
+    qint64 m_meta_time_budget;
     std::unique_ptr<RawAtlasPack> m_atlases;
     QSize m_last_calulated_size;
     BusySmartThread * m_thread;
@@ -168,8 +168,15 @@ void SpriteSheetSplitterWidget::saveAtlas()
         {
             .texture = texture_file_path,
             .color_to_alpha = QString(),
-            .frames = QList<Frame>()
+            .pixel_format = TexturePixelFormat::RGBA8888,
+            .compression = TextureCompression::None,
+            .is_alpha_premultiplied = false,
+            .palette_size = 0,
+            .frames = QList<Frame>(),
+            .grid = std::nullopt
         };
+        if(const GridPack * grid_pack = qobject_cast<const GridPack *>(m_pack.data()))
+            atlas.grid = grid_pack->options();
         atlas.frames.reserve(m_pack->frameCount());
         m_pack->forEachFrame([&atlas](const Frame & __frame) {
             atlas.frames.append(__frame);
@@ -19,6 +19,7 @@
 #include <Sol2dTexturePackerGui/SpriteListWidget.h>
 #include <Sol2dTexturePackerGui/ImageFormat.h>
 #include <Sol2dTexturePackerGui/Settings.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
 #include <QFileDialog>
 #include <QMimeData>
 #include <QShortcut>
@@ -191,7 +192,10 @@ void SpriteListWidget::SpriteListModel::addSprites(const QList<Sprite> & _sprite
             m_sprites.end(),
             [&s](const Sprite & __s) { return __s.path == s.path; });
         if(it == m_sprites.end())
+        {
             sprites.append(s);
+            sprites.last().image = normalizeSpriteImage(s.image);
+        }
     }
     if(!sprites.isEmpty())
     {
@@ -205,6 +209,8 @@ void SpriteListWidget::SpriteListModel::setSprites(const QList<Sprite> & _sprite
 {
     beginResetModel();
     m_sprites = _sprites;
+    for(Sprite & sprite : m_sprites)
+        sprite.image = normalizeSpriteImage(sprite.image);
     endResetModel();
 }
 
@@ -19,11 +19,23 @@
 #pragma once
 
 #include <LibSol2dTexturePacker/Frame.h>
+#include <LibSol2dTexturePacker/TexturePixelFormat.h>
+#include <LibSol2dTexturePacker/Pack/GridPack.h>
+#include <LibSol2dTexturePacker/Packers/TextureCompressor.h>
 #include <QList>
+#include <optional>
 
 struct S2TP_EXPORT Atlas
 {
     QString texture;
     QString color_to_alpha;
+    TexturePixelFormat pixel_format = TexturePixelFormat::RGBA8888;
+    // The block compression of a DDS or KTX2 texture
+    TextureCompression compression = TextureCompression::None;
+    bool is_alpha_premultiplied = false;
+    // The number of colors of an indexed texture
+    int palette_size = 0;
     QList<Frame> frames;
+    // The frames are the cells of a grid, GridPack reads the texture back with these options
+    std::optional<GridOptions> grid;
 };
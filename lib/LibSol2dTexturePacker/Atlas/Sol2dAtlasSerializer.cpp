@@ -23,16 +23,24 @@
 #include <QDir>
 #include <QXmlStreamWriter>
 #include <QDomDocument>
+#include <algorithm>
 
 namespace {
 
 const char * g_xml_tag_atlas = "atlas";
 const char * g_xml_tag_frame = "frame";
+const char * g_xml_tag_grid = "grid";
 const char * g_xml_attr_version = "version";
 const char * g_xml_attr_texture = "texture";
 const char * g_xml_attr_alpha = "alpha";
+const char * g_xml_attr_format = "format";
+const char * g_xml_attr_compression = "compression";
+const char * g_xml_attr_premultiplied = "premultiplied";
+const char * g_xml_attr_palette = "palette";
 const char * g_xml_attr_name = "name";
 const char * g_xml_attr_rotated = "rotated";
+const char * g_xml_attr_flipped_horizontally = "hflip";
+const char * g_xml_attr_flipped_vertically = "vflip";
 const char * g_xml_attr_texture_x = "tx";
 const char * g_xml_attr_texture_y = "ty";
 const char * g_xml_attr_texture_width = "tw";
@@ -41,6 +49,14 @@ const char * g_xml_attr_sprite_x = "sx";
 const char * g_xml_attr_sprite_y = "sy";
 const char * g_xml_attr_sprite_width = "sw";
 const char * g_xml_attr_sprite_height = "sh";
+const char * g_xml_attr_grid_columns = "columns";
+const char * g_xml_attr_grid_rows = "rows";
+const char * g_xml_attr_grid_sprite_width = "width";
+const char * g_xml_attr_grid_sprite_height = "height";
+const char * g_xml_attr_grid_margin_top = "top";
+const char * g_xml_attr_grid_margin_left = "left";
+const char * g_xml_attr_grid_horizontal_spacing = "hspacing";
+const char * g_xml_attr_grid_vertical_spacing = "vspacing";
 
 void validateXmlFrameAttribute(
     const QString & _file,
@@ -84,10 +100,26 @@ Int getXmlFrameIntAttribute(
     return static_cast<Int>(value);
 }
 
+int getXmlGridIntAttribute(const QString & _file, const QDomElement & _xgrid, const char * _attribute_name)
+{
+    bool is_ok;
+    const int value = _xgrid.attribute(_attribute_name).toInt(&is_ok);
+    if(!is_ok)
+    {
+        throw InvalidFileFormatException(
+            _file,
+            QObject::tr("XML element \"%1\" must contain integer attribute \"%2\"")
+                .arg(g_xml_tag_grid)
+                .arg(_attribute_name)
+        );
+    }
+    return value;
+}
+
 } // namespace
 
 
-const int Sol2dAtlasSerializer::m_latest_version = 1;
+const int Sol2dAtlasSerializer::m_latest_version = 2;
 
 void Sol2dAtlasSerializer::serialize(const Atlas & _atlas, const QString & _file)
 {
@@ -100,10 +132,42 @@ void Sol2dAtlasSerializer::serialize(const Atlas & _atlas, const QString & _file
     xml.setAutoFormatting(true);
     xml.writeStartDocument();
     xml.writeStartElement(g_xml_tag_atlas);
-    xml.writeAttribute(g_xml_attr_version, QString::number(m_latest_version));
+    // Flipped frames, premultiplied alpha, reduced pixel formats, compression and palettes came in the second version.
+    // Readers of the first one would ignore them and show the texels wrong, only atlases without them claim it.
+    const bool has_flips = std::any_of(_atlas.frames.cbegin(), _atlas.frames.cend(), [](const Frame & __frame) {
+        return __frame.is_flipped_horizontally || __frame.is_flipped_vertically;
+    });
+    const bool needs_latest_version =
+        has_flips ||
+        _atlas.is_alpha_premultiplied ||
+        _atlas.pixel_format != TexturePixelFormat::RGBA8888 ||
+        _atlas.compression != TextureCompression::None ||
+        _atlas.palette_size > 0;
+    xml.writeAttribute(g_xml_attr_version, QString::number(needs_latest_version ? m_latest_version : 1));
     xml.writeAttribute(g_xml_attr_texture, makeTextureRelativePath(_atlas, _file));
     if(!_atlas.color_to_alpha.isEmpty())
         xml.writeAttribute(g_xml_attr_alpha, _atlas.color_to_alpha);
+    if(_atlas.pixel_format != TexturePixelFormat::RGBA8888)
+        xml.writeAttribute(g_xml_attr_format, texturePixelFormatName(_atlas.pixel_format));
+    if(_atlas.compression != TextureCompression::None)
+        xml.writeAttribute(g_xml_attr_compression, textureCompressionName(_atlas.compression));
+    if(_atlas.is_alpha_premultiplied)
+        xml.writeAttribute(g_xml_attr_premultiplied, "true");
+    if(_atlas.palette_size > 0)
+        xml.writeAttribute(g_xml_attr_palette, QString::number(_atlas.palette_size));
+    if(_atlas.grid)
+    {
+        xml.writeStartElement(g_xml_tag_grid);
+        xml.writeAttribute(g_xml_attr_grid_columns, QString::number(_atlas.grid->column_count));
+        xml.writeAttribute(g_xml_attr_grid_rows, QString::number(_atlas.grid->row_count));
+        xml.writeAttribute(g_xml_attr_grid_sprite_width, QString::number(_atlas.grid->sprite_width));
+        xml.writeAttribute(g_xml_attr_grid_sprite_height, QString::number(_atlas.grid->sprite_height));
+        xml.writeAttribute(g_xml_attr_grid_margin_top, QString::number(_atlas.grid->margin_top));
+        xml.writeAttribute(g_xml_attr_grid_margin_left, QString::number(_atlas.grid->margin_left));
+        xml.writeAttribute(g_xml_attr_grid_horizontal_spacing, QString::number(_atlas.grid->horizontal_spacing));
+        xml.writeAttribute(g_xml_attr_grid_vertical_spacing, QString::number(_atlas.grid->vertical_spacing));
+        xml.writeEndElement();
+    }
     for(int i = 0; i < _atlas.frames.count(); ++i)
     {
         const Frame & frame = _atlas.frames[i];
@@ -122,6 +186,10 @@ void Sol2dAtlasSerializer::serialize(const Atlas & _atlas, const QString & _file
         xml.writeAttribute(g_xml_attr_sprite_height, QString::number(frame.sprite_rect.height()));
         if(frame.is_rotated)
             xml.writeAttribute(g_xml_attr_rotated, "true");
+        if(frame.is_flipped_horizontally)
+            xml.writeAttribute(g_xml_attr_flipped_horizontally, "true");
+        if(frame.is_flipped_vertically)
+            xml.writeAttribute(g_xml_attr_flipped_vertically, "true");
         xml.writeEndElement();
     }
     xml.writeEndElement();
@@ -156,7 +224,7 @@ void Sol2dAtlasSerializer::deserialize(const QString & _file, Atlas & _atlas)
                 _file,
                 QObject::tr("Tag \"%1\" must contain attribute \"%2\"").arg(g_xml_tag_atlas, g_xml_attr_version));
         }
-        if(version != m_latest_version)
+        if(version < 1 || version > m_latest_version)
         {
             throw InvalidFileFormatException(
                 _file,
@@ -171,6 +239,48 @@ void Sol2dAtlasSerializer::deserialize(const QString & _file, Atlas & _atlas)
             tmp_atlas.texture = QFileInfo(_file).dir().absoluteFilePath(tmp_atlas.texture);
     }
     tmp_atlas.color_to_alpha = xatlas.attribute(g_xml_attr_alpha);
+    if(xatlas.hasAttribute(g_xml_attr_format))
+    {
+        const std::optional<TexturePixelFormat> pixel_format =
+            parseTexturePixelFormat(xatlas.attribute(g_xml_attr_format));
+        if(!pixel_format)
+        {
+            throw InvalidFileFormatException(
+                _file,
+                QObject::tr("Unsupported pixel format \"%1\"").arg(xatlas.attribute(g_xml_attr_format)));
+        }
+        tmp_atlas.pixel_format = *pixel_format;
+    }
+    if(xatlas.hasAttribute(g_xml_attr_compression))
+    {
+        const std::optional<TextureCompression> compression =
+            parseTextureCompression(xatlas.attribute(g_xml_attr_compression));
+        if(!compression)
+        {
+            throw InvalidFileFormatException(
+                _file,
+                QObject::tr("Unsupported texture compression \"%1\"").arg(xatlas.attribute(g_xml_attr_compression)));
+        }
+        tmp_atlas.compression = *compression;
+    }
+    tmp_atlas.is_alpha_premultiplied =
+        xatlas.attribute(g_xml_attr_premultiplied).compare("true", Qt::CaseInsensitive) == 0;
+    tmp_atlas.palette_size = xatlas.attribute(g_xml_attr_palette).toInt();
+    const QDomElement xgrid = xatlas.firstChildElement(g_xml_tag_grid);
+    if(!xgrid.isNull())
+    {
+        tmp_atlas.grid = GridOptions
+        {
+            .column_count = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_columns),
+            .row_count = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_rows),
+            .sprite_width = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_sprite_width),
+            .sprite_height = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_sprite_height),
+            .margin_top = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_margin_top),
+            .margin_left = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_margin_left),
+            .horizontal_spacing = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_horizontal_spacing),
+            .vertical_spacing = getXmlGridIntAttribute(_file, xgrid, g_xml_attr_grid_vertical_spacing)
+        };
+    }
     quint32 frame_position = 1;
     for(
         QDomElement xframe = xatlas.firstChildElement(g_xml_tag_frame);
@@ -191,7 +301,11 @@ void Sol2dAtlasSerializer::deserialize(const QString & _file, Atlas & _atlas)
                 getXmlFrameIntAttribute<qint32>(_file, xframe, g_xml_attr_sprite_height, frame_position)
             ),
             .name = xframe.attribute(g_xml_attr_name),
-            .is_rotated = xframe.attribute(g_xml_attr_rotated).compare("true", Qt::CaseInsensitive) == 0
+            .is_rotated = xframe.attribute(g_xml_attr_rotated).compare("true", Qt::CaseInsensitive) == 0,
+            .is_flipped_horizontally =
+                xframe.attribute(g_xml_attr_flipped_horizontally).compare("true", Qt::CaseInsensitive) == 0,
+            .is_flipped_vertically =
+                xframe.attribute(g_xml_attr_flipped_vertically).compare("true", Qt::CaseInsensitive) == 0
         });
         ++frame_position;
     }
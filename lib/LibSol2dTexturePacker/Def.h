@@ -28,4 +28,7 @@
 #   define S2TP_EXPORT
 #endif
 
-
+// SSE2 is a part of every x86-64 processor, MSVC does not define __SSE2__ for it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define S2TP_SSE2
+#endif
@@ -31,7 +31,11 @@ public:
     QRect texture_rect;
     QRect sprite_rect;
     QString name;
+    // The texture holds the sprite turned clockwise
     bool is_rotated;
+    // The sprite is mirrored after the rotation is undone
+    bool is_flipped_horizontally;
+    bool is_flipped_vertically;
 };
 
 Q_DECLARE_METATYPE(Frame)
@@ -0,0 +1,256 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/ImageFormats/QoiCodec.h>
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr char g_magic[] = { 'q', 'o', 'i', 'f' };
+constexpr int g_header_size = 14;
+constexpr std::array<uchar, 8> g_end_marker = { 0, 0, 0, 0, 0, 0, 0, 1 };
+constexpr int g_index_size = 64;
+constexpr int g_max_run = 62;
+// The reference implementation refuses larger images as well
+constexpr qint64 g_max_pixel_count = 400000000;
+
+constexpr uchar g_op_index = 0x00;
+constexpr uchar g_op_diff = 0x40;
+constexpr uchar g_op_luma = 0x80;
+constexpr uchar g_op_run = 0xC0;
+constexpr uchar g_op_rgb = 0xFE;
+constexpr uchar g_op_rgba = 0xFF;
+constexpr uchar g_op_mask = 0xC0;
+
+constexpr uchar g_colorspace_srgb = 0;
+
+struct Pixel
+{
+    uchar r;
+    uchar g;
+    uchar b;
+    uchar a;
+
+    bool operator == (const Pixel & _other) const = default;
+};
+
+inline int indexOf(const Pixel & _pixel)
+{
+    return (_pixel.r * 3 + _pixel.g * 5 + _pixel.b * 7 + _pixel.a * 11) % g_index_size;
+}
+
+// The differences wrap around, as the decoder adds them modulo 256
+inline int difference(uchar _value, uchar _previous)
+{
+    return static_cast<signed char>(static_cast<uchar>(_value - _previous));
+}
+
+} // namespace
+
+bool isQoi(const QByteArray & _header)
+{
+    return _header.size() >= static_cast<qsizetype>(sizeof(g_magic)) &&
+        std::memcmp(_header.constData(), g_magic, sizeof(g_magic)) == 0;
+}
+
+QByteArray encodeQoi(const QImage & _image)
+{
+    if(_image.isNull())
+        return QByteArray();
+    const QImage image = _image.format() == QImage::Format_RGBA8888
+        ? _image
+        : _image.convertToFormat(QImage::Format_RGBA8888);
+    const qint64 pixel_count = static_cast<qint64>(image.width()) * image.height();
+    QByteArray data;
+    // The worst case is a RGBA operation for every pixel
+    data.reserve(g_header_size + pixel_count * 5 + static_cast<qsizetype>(g_end_marker.size()));
+    data.append(g_magic, sizeof(g_magic));
+    const auto appendUInt32 = [&data](quint32 __value) {
+        const quint32 value = qToBigEndian(__value);
+        data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    appendUInt32(static_cast<quint32>(image.width()));
+    appendUInt32(static_cast<quint32>(image.height()));
+    data.append(static_cast<char>(_image.hasAlphaChannel() ? 4 : 3));
+    data.append(static_cast<char>(g_colorspace_srgb));
+
+    std::array<Pixel, g_index_size> index = { };
+    Pixel previous { .r = 0, .g = 0, .b = 0, .a = 255 };
+    int run = 0;
+    const auto append = [&data](int __byte) { data.append(static_cast<char>(__byte)); };
+    for(int y = 0; y < image.height(); ++y)
+    {
+        const uchar * line = image.constScanLine(y);
+        for(int x = 0; x < image.width(); ++x)
+        {
+            const uchar * source = line + x * 4;
+            const Pixel pixel { .r = source[0], .g = source[1], .b = source[2], .a = source[3] };
+            if(pixel == previous)
+            {
+                if(++run == g_max_run)
+                {
+                    append(g_op_run | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if(run > 0)
+            {
+                append(g_op_run | (run - 1));
+                run = 0;
+            }
+            const int position = indexOf(pixel);
+            if(index[position] == pixel)
+            {
+                append(g_op_index | position);
+            }
+            else
+            {
+                index[position] = pixel;
+                if(pixel.a == previous.a)
+                {
+                    const int dr = difference(pixel.r, previous.r);
+                    const int dg = difference(pixel.g, previous.g);
+                    const int db = difference(pixel.b, previous.b);
+                    const int dr_dg = dr - dg;
+                    const int db_dg = db - dg;
+                    if(dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        append(g_op_diff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                    }
+                    else if(dr_dg >= -8 && dr_dg <= 7 && dg >= -32 && dg <= 31 && db_dg >= -8 && db_dg <= 7)
+                    {
+                        append(g_op_luma | (dg + 32));
+                        append(((dr_dg + 8) << 4) | (db_dg + 8));
+                    }
+                    else
+                    {
+                        append(g_op_rgb);
+                        append(pixel.r);
+                        append(pixel.g);
+                        append(pixel.b);
+                    }
+                }
+                else
+                {
+                    append(g_op_rgba);
+                    append(pixel.r);
+                    append(pixel.g);
+                    append(pixel.b);
+                    append(pixel.a);
+                }
+            }
+            previous = pixel;
+        }
+    }
+    if(run > 0)
+        append(g_op_run | (run - 1));
+    data.append(reinterpret_cast<const char *>(g_end_marker.data()), static_cast<qsizetype>(g_end_marker.size()));
+    return data;
+}
+
+QImage decodeQoi(const QByteArray & _data)
+{
+    if(_data.size() < g_header_size + static_cast<qsizetype>(g_end_marker.size()) || !isQoi(_data))
+        return QImage();
+    const uchar * data = reinterpret_cast<const uchar *>(_data.constData());
+    const quint32 width = qFromBigEndian<quint32>(data + 4);
+    const quint32 height = qFromBigEndian<quint32>(data + 8);
+    const uchar channels = data[12];
+    if(width == 0 || height == 0 || (channels != 3 && channels != 4) ||
+        static_cast<qint64>(width) * height > g_max_pixel_count)
+    {
+        return QImage();
+    }
+    // Three channel images keep the alpha byte, which is always opaque
+    QImage image(
+        static_cast<int>(width),
+        static_cast<int>(height),
+        channels == 4 ? QImage::Format_RGBA8888 : QImage::Format_RGBX8888);
+    if(image.isNull())
+        return QImage();
+
+    // The end marker is not part of the pixel data
+    const qsizetype end = _data.size() - static_cast<qsizetype>(g_end_marker.size());
+    qsizetype position = g_header_size;
+    std::array<Pixel, g_index_size> index = { };
+    Pixel pixel { .r = 0, .g = 0, .b = 0, .a = 255 };
+    int run = 0;
+    for(int y = 0; y < image.height(); ++y)
+    {
+        uchar * line = image.scanLine(y);
+        for(int x = 0; x < image.width(); ++x)
+        {
+            if(run > 0)
+            {
+                --run;
+            }
+            else
+            {
+                if(position >= end)
+                    return QImage();
+                const uchar op = data[position++];
+                if(op == g_op_rgb || op == g_op_rgba)
+                {
+                    const qsizetype size = op == g_op_rgb ? 3 : 4;
+                    if(position + size > end)
+                        return QImage();
+                    pixel.r = data[position];
+                    pixel.g = data[position + 1];
+                    pixel.b = data[position + 2];
+                    if(op == g_op_rgba)
+                        pixel.a = data[position + 3];
+                    position += size;
+                }
+                else if((op & g_op_mask) == g_op_index)
+                {
+                    pixel = index[op];
+                }
+                else if((op & g_op_mask) == g_op_diff)
+                {
+                    pixel.r = static_cast<uchar>(pixel.r + ((op >> 4) & 0x03) - 2);
+                    pixel.g = static_cast<uchar>(pixel.g + ((op >> 2) & 0x03) - 2);
+                    pixel.b = static_cast<uchar>(pixel.b + (op & 0x03) - 2);
+                }
+                else if((op & g_op_mask) == g_op_luma)
+                {
+                    if(position >= end)
+                        return QImage();
+                    const uchar next = data[position++];
+                    const int dg = (op & 0x3F) - 32;
+                    pixel.r = static_cast<uchar>(pixel.r + dg - 8 + ((next >> 4) & 0x0F));
+                    pixel.g = static_cast<uchar>(pixel.g + dg);
+                    pixel.b = static_cast<uchar>(pixel.b + dg - 8 + (next & 0x0F));
+                }
+                else
+                {
+                    run = op & 0x3F;
+                }
+                index[indexOf(pixel)] = pixel;
+            }
+            uchar * target = line + x * 4;
+            target[0] = pixel.r;
+            target[1] = pixel.g;
+            target[2] = pixel.b;
+            target[3] = channels == 4 ? pixel.a : 255;
+        }
+    }
+    return image;
+}
@@ -0,0 +1,31 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Def.h>
+#include <QByteArray>
+#include <QImage>
+
+// The Quite OK Image format, see https://qoiformat.org/qoi-specification.pdf
+// Images without alpha are written with three channels, the pixels are encoded the same way.
+S2TP_EXPORT QByteArray encodeQoi(const QImage & _image);
+// Returns a null image when the data is not a valid QOI image
+S2TP_EXPORT QImage decodeQoi(const QByteArray & _data);
+// Tells whether the data starts with the QOI magic
+S2TP_EXPORT bool isQoi(const QByteArray & _header);
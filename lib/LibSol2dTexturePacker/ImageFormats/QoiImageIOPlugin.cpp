@@ -0,0 +1,78 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/ImageFormats/QoiImageIOPlugin.h>
+#include <LibSol2dTexturePacker/ImageFormats/QoiCodec.h>
+#include <QIODevice>
+
+namespace {
+
+const char * g_format = "qoi";
+constexpr qint64 g_magic_size = 4;
+
+} // namespace
+
+bool QoiImageIOHandler::canRead() const
+{
+    if(!canRead(device()))
+        return false;
+    setFormat(g_format);
+    return true;
+}
+
+bool QoiImageIOHandler::canRead(QIODevice * _device)
+{
+    return _device && isQoi(_device->peek(g_magic_size));
+}
+
+bool QoiImageIOHandler::read(QImage * _image)
+{
+    const QImage image = decodeQoi(device()->readAll());
+    if(image.isNull())
+        return false;
+    *_image = image;
+    return true;
+}
+
+bool QoiImageIOHandler::write(const QImage & _image)
+{
+    const QByteArray data = encodeQoi(_image);
+    return !data.isEmpty() && device()->write(data) == data.size();
+}
+
+QImageIOPlugin::Capabilities QoiImageIOPlugin::capabilities(QIODevice * _device, const QByteArray & _format) const
+{
+    if(_format == g_format)
+        return CanRead | CanWrite;
+    if(!_format.isEmpty() || !_device || !_device->isOpen())
+        return {};
+    Capabilities capabilities;
+    if(_device->isReadable() && QoiImageIOHandler::canRead(_device))
+        capabilities |= CanRead;
+    if(_device->isWritable())
+        capabilities |= CanWrite;
+    return capabilities;
+}
+
+QImageIOHandler * QoiImageIOPlugin::create(QIODevice * _device, const QByteArray & _format) const
+{
+    QImageIOHandler * handler = new QoiImageIOHandler();
+    handler->setDevice(_device);
+    handler->setFormat(_format);
+    return handler;
+}
@@ -0,0 +1,43 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <QImageIOHandler>
+#include <QImageIOPlugin>
+
+class QoiImageIOHandler : public QImageIOHandler
+{
+public:
+    bool canRead() const override;
+    bool read(QImage * _image) override;
+    bool write(const QImage & _image) override;
+
+    static bool canRead(QIODevice * _device);
+};
+
+// The library is static, applications bring the plugin in with Q_IMPORT_PLUGIN(QoiImageIOPlugin)
+class QoiImageIOPlugin : public QImageIOPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID QImageIOHandlerFactoryInterface_iid FILE "QoiImageIOPlugin.json")
+
+public:
+    Capabilities capabilities(QIODevice * _device, const QByteArray & _format) const override;
+    QImageIOHandler * create(QIODevice * _device, const QByteArray & _format = QByteArray()) const override;
+};
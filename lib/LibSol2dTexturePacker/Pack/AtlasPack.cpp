@@ -17,6 +17,7 @@
  **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Pack/AtlasPack.h>
+#include <QColor>
 
 AtlasPack::AtlasPack(const Atlas & _atlas, QObject * _parent) :
     Pack(_atlas.texture, _parent),
@@ -29,6 +30,16 @@ qsizetype AtlasPack::frameCount() const
     return m_atlas.frames.count();
 }
 
+std::optional<QRgb> AtlasPack::colorToAlpha() const
+{
+    if(m_atlas.color_to_alpha.isEmpty())
+        return std::nullopt;
+    const QColor color = QColor::fromString(m_atlas.color_to_alpha);
+    if(!color.isValid())
+        return std::nullopt;
+    return color.rgb();
+}
+
 bool AtlasPack::forEachFrame(std::function<void (const Frame &)> _cb) const
 {
     foreach(const Frame & frame, m_atlas.frames)
@@ -29,6 +29,8 @@ public:
     explicit AtlasPack(const Atlas & _atlas, QObject * _parent = nullptr);
     qsizetype frameCount() const override;
     bool forEachFrame(std::function<void (const Frame &)> _cb) const override;
+    bool isAlphaPremultiplied() const override { return m_atlas.is_alpha_premultiplied; }
+    std::optional<QRgb> colorToAlpha() const override;
     const Atlas & atlas() const { return m_atlas; }
 
 private:
@@ -124,7 +124,9 @@ bool GridPack::forEachFrame(std::function<void (const Frame &)> _cb) const
         .texture_rect = QRect(0, 0, m_options.sprite_width, m_options.sprite_height),
         .sprite_rect = QRect(0, 0, m_options.sprite_width, m_options.sprite_height),
         .name = QString(),
-        .is_rotated = false
+        .is_rotated = false,
+        .is_flipped_horizontally = false,
+        .is_flipped_vertically = false
     };
     int index = 0;
     for(qint32 row = 0; row < m_options.row_count; ++row)
@@ -17,6 +17,7 @@
 **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Pack/Pack.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
 #include <LibSol2dTexturePacker/Exception.h>
 #include <QPainter>
 
@@ -32,12 +33,16 @@ void Pack::unpack(const QDir & _output_dir, const QString & _format) const
 Sprite Pack::unpackFrame(const Frame & _frame, const QDir & _output_dir, const QString & _format) const
 {
     QImage texture_sprite = texture().copy(_frame.texture_rect);
+    if(const std::optional<QRgb> color_to_alpha = colorToAlpha())
+        texture_sprite = applyColorToAlpha(texture_sprite, *color_to_alpha);
     if(_frame.is_rotated)
     {
         QTransform rotation;
         rotation.rotate(-90);
         texture_sprite = texture_sprite.transformed(rotation);
     }
+    if(_frame.is_flipped_horizontally || _frame.is_flipped_vertically)
+        texture_sprite = texture_sprite.mirrored(_frame.is_flipped_horizontally, _frame.is_flipped_vertically);
     QImage img(_frame.sprite_rect.width(), _frame.sprite_rect.height(), QImage::Format_RGBA8888);
     img.fill(0);
     QPainter painter(&img);
@@ -58,6 +63,13 @@ const QImage & Pack::texture() const
     {
         if(!m_texture.load(m_texture_filename))
             throw ImageLoadingException(m_texture_filename);
+        if(isAlphaPremultiplied())
+        {
+            // The file format knows nothing about premultiplication, so the pixels are only relabelled.
+            // Painting the texture then divides the colors by alpha where straight alpha is needed.
+            m_texture.convertTo(QImage::Format_RGBA8888);
+            m_texture.reinterpretAsFormat(QImage::Format_RGBA8888_Premultiplied);
+        }
     }
     return m_texture;
 }
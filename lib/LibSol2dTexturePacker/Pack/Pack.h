@@ -23,6 +23,7 @@
 #include <QImage>
 #include <QDir>
 #include <QObject>
+#include <optional>
 
 class S2TP_EXPORT Pack : public QObject
 {
@@ -42,6 +43,10 @@ public:
     const QString & textureFilename() const { return m_texture_filename; }
     virtual qsizetype frameCount() const = 0;
     virtual bool forEachFrame(std::function<void(const Frame &)> _cb) const = 0;
+    // The texture file holds colors multiplied by alpha
+    virtual bool isAlphaPremultiplied() const { return false; }
+    // The color that readers have to make transparent, if the packer has not done it already
+    virtual std::optional<QRgb> colorToAlpha() const { return std::nullopt; }
 
 private:
     QString makeUnpackFilename(const QDir & _output_dir, const QString & _format, const Frame & _frame) const;
@@ -0,0 +1,377 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/AnnealingAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/IndexedMaxRectsAlgorithm.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Packers/AtlasPackCostModel.h>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+
+namespace {
+
+constexpr qint64 g_default_iteration_limit = 2000;
+// Chains synchronise after each round, which keeps the search deterministic and lets it be canceled
+constexpr int g_iterations_per_round = 16;
+constexpr int g_search_progress_range = 900;
+constexpr int g_progress_range = 1000;
+// Temperatures are relative to the cost, a layout 1% worse than the current one is accepted
+// with a probability of 1/e at the initial temperature
+constexpr double g_initial_temperature = 0.01;
+constexpr double g_final_temperature = 0.00001;
+constexpr qint64 g_publish_interval = 1000;
+
+struct Unit
+{
+    int width;
+    int height;
+};
+
+struct Layout
+{
+    std::vector<int> order;
+    std::vector<char> rotations;
+};
+
+struct Chain
+{
+    std::mt19937 random;
+    std::unique_ptr<IndexedMaxRectsAlgorithm> algorithm;
+    Layout current;
+    AtlasPackCost current_cost;
+    Layout best;
+    AtlasPackCost best_cost;
+    qint64 iteration_count = 0;
+};
+
+const AtlasPackCost g_invalid_cost
+{
+    .primary = std::numeric_limits<double>::max(),
+    .secondary = std::numeric_limits<double>::max()
+};
+
+// The total area of the atlases, then their number
+AtlasPackCost evaluate(IndexedMaxRectsAlgorithm & _algorithm, const std::vector<Unit> & _units, const Layout & _layout)
+{
+    _algorithm.resetBin();
+    qint64 area = 0;
+    int atlas_count = 0;
+    int max_x = 0;
+    int max_y = 0;
+    bool is_bin_empty = true;
+    for(int unit_index : _layout.order)
+    {
+        const Unit & unit = _units[unit_index];
+        const bool is_rotated = _layout.rotations[unit_index];
+        for(;;)
+        {
+            const QRect rect = is_rotated
+                ? _algorithm.insert(unit.height, unit.width)
+                : _algorithm.insert(unit.width, unit.height);
+            if(!rect.isNull())
+            {
+                max_x = std::max(max_x, rect.x() + rect.width());
+                max_y = std::max(max_y, rect.y() + rect.height());
+                is_bin_empty = false;
+                break;
+            }
+            if(is_bin_empty)
+                return g_invalid_cost;
+            area += static_cast<qint64>(max_x) * max_y;
+            ++atlas_count;
+            max_x = 0;
+            max_y = 0;
+            is_bin_empty = true;
+            _algorithm.resetBin();
+        }
+    }
+    if(!is_bin_empty)
+    {
+        area += static_cast<qint64>(max_x) * max_y;
+        ++atlas_count;
+    }
+    return AtlasPackCost { .primary = static_cast<double>(area), .secondary = static_cast<double>(atlas_count) };
+}
+
+// std distributions differ between standard libraries, so the numbers are derived from the engine directly
+int randomIndex(std::mt19937 & _random, int _count)
+{
+    return static_cast<int>(_random() % static_cast<quint32>(_count));
+}
+
+double randomUnit(std::mt19937 & _random)
+{
+    return static_cast<double>(_random()) / 4294967296.0;
+}
+
+void mutate(Layout & _layout, std::mt19937 & _random, bool _allow_flip)
+{
+    const int count = static_cast<int>(_layout.order.size());
+    if(count == 0)
+        return;
+    const int move = randomIndex(_random, _allow_flip ? 4 : 3);
+    if(move == 3 || count < 2)
+    {
+        if(_allow_flip)
+        {
+            char & rotation = _layout.rotations[_layout.order[randomIndex(_random, count)]];
+            rotation = !rotation;
+        }
+        return;
+    }
+    int first = randomIndex(_random, count);
+    int second = randomIndex(_random, count - 1);
+    if(second >= first)
+        ++second;
+    switch(move)
+    {
+    case 0:
+        std::swap(_layout.order[first], _layout.order[second]);
+        break;
+    case 1:
+        // Moves the sprite at the first position to the second one
+        if(first < second)
+            std::rotate(_layout.order.begin() + first, _layout.order.begin() + first + 1, _layout.order.begin() + second + 1);
+        else
+            std::rotate(_layout.order.begin() + second, _layout.order.begin() + first, _layout.order.begin() + first + 1);
+        break;
+    default:
+        if(first > second)
+            std::swap(first, second);
+        std::reverse(_layout.order.begin() + first, _layout.order.begin() + second + 1);
+        break;
+    }
+}
+
+Layout createInitialLayout(const std::vector<Unit> & _units, int _chain_index, bool _allow_flip)
+{
+    typedef std::function<qint64(const Unit &)> Key;
+    static const Key keys[] =
+    {
+        [](const Unit & __unit) { return static_cast<qint64>(std::max(__unit.width, __unit.height)); },
+        [](const Unit & __unit) { return static_cast<qint64>(__unit.width) * __unit.height; },
+        [](const Unit & __unit) { return static_cast<qint64>(__unit.height); },
+        [](const Unit & __unit) { return static_cast<qint64>(__unit.width); },
+        [](const Unit & __unit) { return static_cast<qint64>(__unit.width) + __unit.height; }
+    };
+    constexpr int key_count = sizeof(keys) / sizeof(keys[0]);
+    Layout layout;
+    const int count = static_cast<int>(_units.size());
+    layout.order.resize(count);
+    layout.rotations.assign(count, 0);
+    for(int i = 0; i < count; ++i)
+        layout.order[i] = i;
+    // The last initial layout keeps the input order
+    if(_chain_index % (key_count + 1) == key_count)
+        return layout;
+    const Key & key = keys[_chain_index % (key_count + 1)];
+    std::stable_sort(layout.order.begin(), layout.order.end(), [&](int __a, int __b) {
+        return key(_units[__a]) > key(_units[__b]);
+    });
+    // Odd chains start with all sprites lying on their long side
+    if(_allow_flip && _chain_index % 2 == 1)
+    {
+        for(int i = 0; i < count; ++i)
+            layout.rotations[i] = _units[i].height > _units[i].width;
+    }
+    return layout;
+}
+
+void anneal(
+    Chain & _chain,
+    const std::vector<Unit> & _units,
+    int _iteration_count,
+    double _temperature,
+    bool _allow_flip,
+    const QDeadlineTimer & _deadline)
+{
+    for(int i = 0; i < _iteration_count && !_deadline.hasExpired(); ++i)
+    {
+        Layout candidate = _chain.current;
+        mutate(candidate, _chain.random, _allow_flip);
+        const AtlasPackCost cost = evaluate(*_chain.algorithm, _units, candidate);
+        ++_chain.iteration_count;
+        if(cost.primary == g_invalid_cost.primary)
+            continue;
+        const double delta = (cost.primary - _chain.current_cost.primary) / std::max(1.0, _chain.current_cost.primary);
+        if(cost < _chain.current_cost || randomUnit(_chain.random) < std::exp(-delta / _temperature))
+        {
+            _chain.current = std::move(candidate);
+            _chain.current_cost = cost;
+            if(cost < _chain.best_cost)
+            {
+                _chain.best = _chain.current;
+                _chain.best_cost = cost;
+            }
+        }
+    }
+}
+
+} // namespace
+
+AnnealingAtlasPacker::AnnealingAtlasPacker(QObject * _parent) :
+    AtlasPacker(_parent),
+    m_heuristic(MaxRectsBinAtlasPackerChoiceHeuristic::BestShortSideFit),
+    m_allow_flip(true),
+    m_time_budget(0),
+    m_iteration_limit(0),
+    m_chain_count(8),
+    m_seed(1)
+{
+}
+
+std::unique_ptr<RawAtlasPack> AnnealingAtlasPacker::pack(
+    AtlasPackerContext & _context,
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options) const
+{
+    _context.setProgressMaximum(g_progress_range);
+    PackStatistics search_statistics;
+
+    // Duplicates always follow their original, so only unique sprites are arranged
+    const QList<UniqueSprite> unique_sprites = collectUniqueSprites(_sprites, _options, _context, search_statistics);
+    if(_context.isCanceled())
+        return nullptr;
+    std::vector<Unit> units;
+    units.reserve(unique_sprites.count());
+    for(const UniqueSprite & sprite : unique_sprites)
+    {
+        const QSize size = alignSpriteSize(sprite.rect.size(), _options.block_size);
+        units.push_back({ .width = size.width(), .height = size.height() });
+    }
+    const QSize bin_size = alignAtlasSize(_options.max_atlas_size, _options.block_size);
+
+    const int chain_count = std::max(1, m_chain_count);
+    const qint64 iteration_limit = m_iteration_limit > 0 || m_time_budget > 0
+        ? m_iteration_limit
+        : g_default_iteration_limit;
+    const QDeadlineTimer deadline = m_time_budget > 0
+        ? QDeadlineTimer(m_time_budget)
+        : QDeadlineTimer(QDeadlineTimer::Forever);
+    QElapsedTimer elapsed_timer;
+    elapsed_timer.start();
+    MaxRectsBinAtlasPacker packer;
+    packer.allowFlip(false);
+    packer.setChoiceHeuristic(m_heuristic);
+
+    const auto createOrder = [&](const Layout & __layout) {
+        SpritePlacementOrder order;
+        order.indices.reserve(_sprites.count());
+        order.rotations.fill(false, _sprites.count());
+        for(int unit_index : __layout.order)
+        {
+            const UniqueSprite & sprite = unique_sprites[unit_index];
+            order.rotations[order.indices.count()] = __layout.rotations[unit_index];
+            order.indices.append(sprite.index);
+            for(qsizetype duplicate : sprite.duplicates)
+            {
+                order.rotations[order.indices.count()] = __layout.rotations[unit_index];
+                order.indices.append(duplicate);
+            }
+        }
+        return order;
+    };
+
+    std::vector<Chain> chains(chain_count);
+    Layout best_layout;
+    AtlasPackCost best_cost = g_invalid_cost;
+    {
+        PackPhaseTimer timer(search_statistics.phase(PackPhase::Placement));
+        for(int i = 0; i < chain_count; ++i)
+        {
+            Chain & chain = chains[i];
+            chain.random.seed(m_seed + static_cast<quint32>(i));
+            chain.algorithm = std::make_unique<IndexedMaxRectsAlgorithm>(bin_size, m_heuristic, false);
+            chain.current = createInitialLayout(units, i, m_allow_flip);
+            chain.current_cost = evaluate(*chain.algorithm, units, chain.current);
+            chain.best = chain.current;
+            chain.best_cost = chain.current_cost;
+            if(chain.best_cost < best_cost)
+            {
+                best_layout = chain.best;
+                best_cost = chain.best_cost;
+            }
+        }
+        // A sprite that does not fit into an empty atlas, the regular packer reports it
+        if(best_cost.primary == g_invalid_cost.primary)
+            return packer.pack(_context, _sprites, _options);
+
+        QElapsedTimer publish_timer;
+        publish_timer.start();
+        bool has_unpublished_result = false;
+        for(qint64 iteration = 0;; iteration += g_iterations_per_round)
+        {
+            if(_context.isCanceled())
+                return nullptr;
+            if((iteration_limit > 0 && iteration >= iteration_limit) || deadline.hasExpired())
+                break;
+            double progress = 0.0;
+            if(iteration_limit > 0)
+                progress = static_cast<double>(iteration) / static_cast<double>(iteration_limit);
+            if(m_time_budget > 0)
+                progress = std::max(progress, static_cast<double>(elapsed_timer.elapsed()) / static_cast<double>(m_time_budget));
+            progress = std::min(progress, 1.0);
+            _context.setProgressValue(static_cast<int>(progress * g_search_progress_range));
+            const double temperature = g_initial_temperature * std::pow(g_final_temperature / g_initial_temperature, progress);
+            const int round_iteration_count = iteration_limit > 0
+                ? static_cast<int>(std::min<qint64>(g_iterations_per_round, iteration_limit - iteration))
+                : g_iterations_per_round;
+            QtConcurrent::blockingMap(chains, [&](Chain & __chain) {
+                anneal(__chain, units, round_iteration_count, temperature, m_allow_flip, deadline);
+            });
+            // Chains are compared in the same order every round, so ties are resolved the same way
+            for(const Chain & chain : chains)
+            {
+                if(chain.best_cost < best_cost)
+                {
+                    best_layout = chain.best;
+                    best_cost = chain.best_cost;
+                    has_unpublished_result = true;
+                }
+            }
+            if(has_unpublished_result && _context.hasResultCallback() && publish_timer.elapsed() >= g_publish_interval)
+            {
+                const int progress_value = static_cast<int>(progress * g_search_progress_range);
+                AtlasPackerContext publish_context(_context, progress_value, progress_value);
+                std::unique_ptr<RawAtlasPack> intermediate = packer.pack(publish_context, _sprites, _options, createOrder(best_layout));
+                if(!intermediate)
+                    return nullptr;
+                _context.publishResult(*intermediate);
+                has_unpublished_result = false;
+                publish_timer.restart();
+            }
+        }
+        for(const Chain & chain : chains)
+            search_statistics.trial_count += chain.iteration_count;
+    }
+
+    AtlasPackerContext final_context(_context, g_search_progress_range, g_progress_range);
+    std::unique_ptr<RawAtlasPack> result = packer.pack(final_context, _sprites, _options, createOrder(best_layout));
+    if(!result)
+        return nullptr;
+    result->statistics().addPhases(search_statistics);
+    result->statistics().trial_count = search_statistics.trial_count;
+    _context.setProgressValue(g_progress_range);
+    return result;
+}
@@ -0,0 +1,58 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/MaxRectsBinAtlasPacker.h>
+
+// Searches for the order and the orientation of sprites that give the smallest total atlas area with MaxRects.
+// Several simulated annealing chains run in parallel, each with its own random generator derived from the seed,
+// so the result only depends on the seed, the number of chains and the number of iterations. When the time budget
+// stops the search first, the best layout found so far is used. Without a time budget and an iteration limit
+// each chain makes a fixed number of iterations.
+class S2TP_EXPORT AnnealingAtlasPacker final : public AtlasPacker
+{
+public:
+    explicit AnnealingAtlasPacker(QObject * _parent = nullptr);
+    void allowFlip(bool _allow) { m_allow_flip = _allow; }
+    bool isFlipAllowed() const { return m_allow_flip; }
+    void setChoiceHeuristic(MaxRectsBinAtlasPackerChoiceHeuristic _heuristic) { m_heuristic = _heuristic; }
+    MaxRectsBinAtlasPackerChoiceHeuristic choiceHeuristic() const { return m_heuristic; }
+    // Zero means no limit
+    void setTimeBudget(qint64 _milliseconds) { m_time_budget = _milliseconds; }
+    qint64 timeBudget() const { return m_time_budget; }
+    // The number of layouts each chain evaluates, zero means no limit
+    void setIterationLimit(qint64 _iterations) { m_iteration_limit = _iterations; }
+    qint64 iterationLimit() const { return m_iteration_limit; }
+    void setChainCount(int _count) { m_chain_count = _count; }
+    int chainCount() const { return m_chain_count; }
+    void setSeed(quint32 _seed) { m_seed = _seed; }
+    quint32 seed() const { return m_seed; }
+
+    std::unique_ptr<RawAtlasPack> pack(
+        AtlasPackerContext & _context,
+        const QList<Sprite> & _sprites,
+        const AtlasPackerOptions & _options) const override;
+
+private:
+    MaxRectsBinAtlasPackerChoiceHeuristic m_heuristic;
+    bool m_allow_flip;
+    qint64 m_time_budget;
+    qint64 m_iteration_limit;
+    int m_chain_count;
+    quint32 m_seed;
+};
@@ -0,0 +1,163 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/AtlasPackCostModel.h>
+#include <QtMath>
+#include <array>
+#include <cmath>
+
+namespace {
+
+double calculateArea(const RawAtlasPack & _pack)
+{
+    double area = 0.0;
+    for(const RawAtlas & atlas : _pack)
+        area += static_cast<double>(atlas.image.width()) * atlas.image.height();
+    return area;
+}
+
+double calculateAreaBound(const AtlasPackBound & _bound)
+{
+    double area = static_cast<double>(_bound.remaining_sprite_area);
+    for(const QSize & size : _bound.closed_atlas_sizes)
+        area += static_cast<double>(size.width()) * size.height();
+    return area;
+}
+
+quint32 ceilPowerOfTwo(int _value)
+{
+    return _value <= 1 ? 1 : qNextPowerOfTwo(static_cast<quint32>(_value - 1));
+}
+
+// Order-0 entropy of the difference between each byte and the same channel of the previous pixel.
+// This is the residual a PNG "Sub" filter produces, so it roughly follows what a lossless encoder achieves.
+double estimateCompressedSize(const QImage & _image)
+{
+    const QImage image = _image.format() == QImage::Format_RGBA8888
+        ? _image
+        : _image.convertToFormat(QImage::Format_RGBA8888);
+    std::array<quint64, 256> histogram {};
+    const int row_size = image.width() * 4;
+    for(int y = 0; y < image.height(); ++y)
+    {
+        const uchar * row = image.constScanLine(y);
+        for(int i = 0; i < row_size && i < 4; ++i)
+            ++histogram[row[i]];
+        for(int i = 4; i < row_size; ++i)
+            ++histogram[static_cast<uchar>(row[i] - row[i - 4])];
+    }
+    const double total = static_cast<double>(row_size) * image.height();
+    double bits = 0.0;
+    for(quint64 count : histogram)
+    {
+        if(count != 0)
+            bits += static_cast<double>(count) * std::log2(total / static_cast<double>(count));
+    }
+    return bits / 8.0;
+}
+
+class TotalAreaCostModel final : public AtlasPackCostModel
+{
+public:
+    AtlasPackCost cost(const RawAtlasPack & _pack) const override
+    {
+        return { .primary = calculateArea(_pack) };
+    }
+
+    AtlasPackCost lowerBound(const AtlasPackBound & _bound) const override
+    {
+        return { .primary = calculateAreaBound(_bound) };
+    }
+};
+
+class AtlasCountThenAreaCostModel final : public AtlasPackCostModel
+{
+public:
+    AtlasPackCost cost(const RawAtlasPack & _pack) const override
+    {
+        return { .primary = static_cast<double>(_pack.count()), .secondary = calculateArea(_pack) };
+    }
+
+    AtlasPackCost lowerBound(const AtlasPackBound & _bound) const override
+    {
+        const double max_atlas_area = static_cast<double>(_bound.max_atlas_size.width()) * _bound.max_atlas_size.height();
+        const double open_atlas_count = max_atlas_area > 0.0
+            ? std::ceil(static_cast<double>(_bound.remaining_sprite_area) / max_atlas_area)
+            : 0.0;
+        return
+        {
+            .primary = static_cast<double>(_bound.closed_atlas_sizes.count()) + open_atlas_count,
+            .secondary = calculateAreaBound(_bound)
+        };
+    }
+};
+
+// GPUs allocate textures padded to powers of two
+class VideoMemoryCostModel final : public AtlasPackCostModel
+{
+public:
+    AtlasPackCost cost(const RawAtlasPack & _pack) const override
+    {
+        double bytes = 0.0;
+        for(const RawAtlas & atlas : _pack)
+        {
+            bytes += static_cast<double>(ceilPowerOfTwo(atlas.image.width())) *
+                ceilPowerOfTwo(atlas.image.height()) * (atlas.image.depth() / 8);
+        }
+        return { .primary = bytes, .secondary = calculateArea(_pack) };
+    }
+
+    // Atlases are rendered as RGBA8888, four bytes per pixel
+    AtlasPackCost lowerBound(const AtlasPackBound & _bound) const override
+    {
+        double bytes = static_cast<double>(_bound.remaining_sprite_area) * 4;
+        for(const QSize & size : _bound.closed_atlas_sizes)
+            bytes += static_cast<double>(ceilPowerOfTwo(size.width())) * ceilPowerOfTwo(size.height()) * 4;
+        return { .primary = bytes, .secondary = calculateAreaBound(_bound) };
+    }
+};
+
+class CompressedSizeCostModel final : public AtlasPackCostModel
+{
+public:
+    AtlasPackCost cost(const RawAtlasPack & _pack) const override
+    {
+        double bytes = 0.0;
+        for(const RawAtlas & atlas : _pack)
+            bytes += estimateCompressedSize(atlas.image);
+        return { .primary = bytes, .secondary = calculateArea(_pack) };
+    }
+};
+
+} // namespace
+
+std::shared_ptr<const AtlasPackCostModel> AtlasPackCostModel::create(AtlasPackCostModelType _type)
+{
+    switch(_type)
+    {
+    case AtlasPackCostModelType::AtlasCountThenArea:
+        return std::make_shared<AtlasCountThenAreaCostModel>();
+    case AtlasPackCostModelType::VideoMemory:
+        return std::make_shared<VideoMemoryCostModel>();
+    case AtlasPackCostModelType::CompressedSize:
+        return std::make_shared<CompressedSizeCostModel>();
+    case AtlasPackCostModelType::TotalArea:
+    default:
+        return std::make_shared<TotalAreaCostModel>();
+    }
+}
@@ -0,0 +1,74 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/RawAtlasPack.h>
+#include <QSize>
+#include <memory>
+
+enum class S2TP_EXPORT AtlasPackCostModelType
+{
+    TotalArea,
+    AtlasCountThenArea,
+    VideoMemory,
+    CompressedSize
+};
+
+// Costs are compared lexicographically, a lower cost is better
+struct S2TP_EXPORT AtlasPackCost
+{
+    double primary = 0.0;
+    double secondary = 0.0;
+};
+
+inline bool operator < (const AtlasPackCost & _left, const AtlasPackCost & _right)
+{
+    return _left.primary < _right.primary || (_left.primary == _right.primary && _left.secondary < _right.secondary);
+}
+
+inline bool isWithinTolerance(const AtlasPackCost & _cost, const AtlasPackCost & _bound, double _tolerance)
+{
+    return
+        _cost.primary <= _bound.primary * (1.0 + _tolerance) &&
+        _cost.secondary <= _bound.secondary * (1.0 + _tolerance);
+}
+
+// What is already known about a pack that is still being built
+struct S2TP_EXPORT AtlasPackBound
+{
+    QSize max_atlas_size;
+    QList<QSize> closed_atlas_sizes;
+    // The area of unique sprites that are not in closed atlases yet
+    qint64 remaining_sprite_area = 0;
+};
+
+class S2TP_EXPORT AtlasPackCostModel
+{
+public:
+    virtual ~AtlasPackCostModel() { }
+    virtual AtlasPackCost cost(const RawAtlasPack & _pack) const = 0;
+    // No pack that extends the bound can cost less. The default bound is trivial and never prunes anything.
+    virtual AtlasPackCost lowerBound(const AtlasPackBound & _bound) const
+    {
+        Q_UNUSED(_bound);
+        return {};
+    }
+
+    static std::shared_ptr<const AtlasPackCostModel> create(AtlasPackCostModelType _type);
+};
@@ -18,17 +18,31 @@
 
 #pragma once
 
+#include <LibSol2dTexturePacker/Packers/AtlasPackerContext.h>
 #include <LibSol2dTexturePacker/Packers/RawAtlasPack.h>
 #include <LibSol2dTexturePacker/Sprite.h>
-#include <QPromise>
 #include <QObject>
+#include <QRgb>
+#include <optional>
 
 struct S2TP_EXPORT AtlasPackerOptions
 {
     QSize max_atlas_size = QSize(2048, 2048);
     bool detect_duplicates = false;
+    // Sprites that are mirrored or turned by a right angle copies of others are duplicates too
+    bool detect_transformed_duplicates = false;
     bool crop = false;
+    // Pixels of this color become transparent before the sprites are cropped, the alpha of the color is ignored
+    std::optional<QRgb> color_to_alpha;
     bool remove_file_extensions = true;
+    // Atlases are rendered with the colors multiplied by alpha, as blending with premultiplied alpha expects
+    bool premultiply_alpha = false;
+    // Sprites start on multiples of the block size and keep the rest of their last blocks to themselves.
+    // Block compressed textures need 4, so that trimmed sprites do not bleed into each other.
+    int block_size = 1;
+    // Sprites are padded and cropped to multiples of the lattice, so that the layout divides exactly
+    // by any factor of it. The block size must be a multiple of the lattice.
+    int scale_lattice = 1;
 };
 
 class S2TP_EXPORT AtlasPacker : public QObject
@@ -41,17 +55,10 @@ public:
     }
 
     virtual std::unique_ptr<RawAtlasPack> pack(
-        QPromise<void> & _promise,
+        AtlasPackerContext & _context,
         const QList<Sprite> & _sprites,
         const AtlasPackerOptions & _options) const = 0;
 
-protected:
-    bool isCanceled(QPromise<void> & _promise) const
-    {
-        _promise.suspendIfRequested();
-        return _promise.isCanceled();
-    }
-
 protected:
     QSize m_max_atlas_size;
 };
@@ -0,0 +1,108 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/AtlasPackerContext.h>
+#include <algorithm>
+
+AtlasPackerContext::AtlasPackerContext(QPromise<void> & _promise) :
+    m_promise(_promise),
+    m_parent(nullptr),
+    m_parent_progress_from(0),
+    m_parent_progress_to(0),
+    m_progress_maximum(0),
+    m_deadline(QDeadlineTimer::Forever)
+{
+}
+
+AtlasPackerContext::AtlasPackerContext(
+    AtlasPackerContext & _parent,
+    int _parent_progress_from,
+    int _parent_progress_to
+) :
+    m_promise(_parent.m_promise),
+    m_parent(&_parent),
+    m_parent_progress_from(_parent_progress_from),
+    m_parent_progress_to(_parent_progress_to),
+    m_progress_maximum(0),
+    m_deadline(QDeadlineTimer::Forever)
+{
+}
+
+bool AtlasPackerContext::isCanceled() const
+{
+    if(m_parent)
+    {
+        if(m_parent->isCanceled())
+            return true;
+    }
+    else
+    {
+        m_promise.suspendIfRequested();
+        if(m_promise.isCanceled())
+            return true;
+    }
+    return !m_deadline.isForever() && m_deadline.hasExpired();
+}
+
+bool AtlasPackerContext::hasResultCallback() const
+{
+    return m_parent ? m_parent->hasResultCallback() : static_cast<bool>(m_result_callback);
+}
+
+void AtlasPackerContext::publishResult(const RawAtlasPack & _pack)
+{
+    if(m_parent)
+        m_parent->publishResult(_pack);
+    else if(m_result_callback)
+        m_result_callback(_pack);
+}
+
+bool AtlasPackerContext::isBoundExceeded(const AtlasPackBound & _bound) const
+{
+    return m_bound_callback && m_bound_callback(_bound);
+}
+
+void AtlasPackerContext::setProgressMaximum(int _maximum)
+{
+    m_progress_maximum = _maximum;
+    if(m_parent == nullptr)
+    {
+        m_promise.setProgressRange(0, _maximum);
+        if(m_progress_callback)
+            m_progress_callback(0, _maximum);
+    }
+}
+
+void AtlasPackerContext::setProgressValue(int _value)
+{
+    if(m_parent)
+    {
+        // A nested context maps its own range onto the range the parent has reserved for it
+        if(m_progress_maximum <= 0)
+            return;
+        const qint64 span = m_parent_progress_to - m_parent_progress_from;
+        m_parent->setProgressValue(
+            m_parent_progress_from + static_cast<int>(span * std::min(_value, m_progress_maximum) / m_progress_maximum));
+    }
+    else
+    {
+        m_promise.setProgressValue(_value);
+        if(m_progress_callback)
+            m_progress_callback(_value, m_progress_maximum);
+    }
+}
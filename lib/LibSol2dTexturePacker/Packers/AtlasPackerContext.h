@@ -0,0 +1,68 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Def.h>
+#include <QPromise>
+#include <QDeadlineTimer>
+#include <functional>
+
+class RawAtlasPack;
+struct AtlasPackBound;
+
+class S2TP_EXPORT AtlasPackerContext final
+{
+    Q_DISABLE_COPY_MOVE(AtlasPackerContext)
+
+public:
+    typedef std::function<void(int _value, int _maximum)> ProgressCallback;
+    typedef std::function<void(const RawAtlasPack & _pack)> ResultCallback;
+    typedef std::function<bool(const AtlasPackBound & _bound)> BoundCallback;
+
+public:
+    explicit AtlasPackerContext(QPromise<void> & _promise);
+    AtlasPackerContext(AtlasPackerContext & _parent, int _parent_progress_from, int _parent_progress_to);
+
+    bool isCanceled() const;
+    // A context behaves as canceled after the deadline, the job itself can still be continued by the caller
+    void setDeadline(const QDeadlineTimer & _deadline) { m_deadline = _deadline; }
+    void setProgressMaximum(int _maximum);
+    void setProgressValue(int _value);
+    void setProgressCallback(ProgressCallback _callback) { m_progress_callback = std::move(_callback); }
+    // Intermediate results are published by packers that improve their result over time
+    bool hasResultCallback() const;
+    void publishResult(const RawAtlasPack & _pack);
+    void setResultCallback(ResultCallback _callback) { m_result_callback = std::move(_callback); }
+    // Packers report lower bounds of their result. When the bound is exceeded, the job cannot beat
+    // the best known result and should be abandoned by returning nullptr.
+    bool hasBoundCallback() const { return static_cast<bool>(m_bound_callback); }
+    bool isBoundExceeded(const AtlasPackBound & _bound) const;
+    void setBoundCallback(BoundCallback _callback) { m_bound_callback = std::move(_callback); }
+
+private:
+    QPromise<void> & m_promise;
+    AtlasPackerContext * m_parent;
+    int m_parent_progress_from;
+    int m_parent_progress_to;
+    int m_progress_maximum;
+    QDeadlineTimer m_deadline;
+    ProgressCallback m_progress_callback;
+    ResultCallback m_result_callback;
+    BoundCallback m_bound_callback;
+};
@@ -0,0 +1,166 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/AtlasScaling.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+inline int divideUp(int _value, int _divisor)
+{
+    return (_value + _divisor - 1) / _divisor;
+}
+
+QRect downscaleRect(const QRect & _rect, int _factor)
+{
+    return QRect(
+        _rect.x() / _factor,
+        _rect.y() / _factor,
+        divideUp(_rect.width(), _factor),
+        divideUp(_rect.height(), _factor));
+}
+
+// Premultiplied colors are averaged as they are, straight ones are weighted by alpha and divided by its sum
+void downscaleRow(const QImage & _image, int _row, int _factor, bool _is_premultiplied, uchar * _out)
+{
+    const int width = divideUp(_image.width(), _factor);
+    const quint32 area = static_cast<quint32>(_factor * _factor);
+    QList<quint32> sums(static_cast<qsizetype>(width) * 4);
+    const int bottom = std::min(_image.height(), (_row + 1) * _factor);
+    for(int y = _row * _factor; y < bottom; ++y)
+    {
+        const uchar * line = _image.constScanLine(y);
+        for(int column = 0; column < width; ++column)
+        {
+            quint32 * sum = sums.data() + column * 4;
+            const int right = std::min(_image.width(), (column + 1) * _factor);
+            for(int x = column * _factor; x < right; ++x)
+            {
+                const uchar * pixel = line + x * 4;
+                const quint32 weight = _is_premultiplied ? 1 : pixel[3];
+                sum[0] += pixel[0] * weight;
+                sum[1] += pixel[1] * weight;
+                sum[2] += pixel[2] * weight;
+                sum[3] += pixel[3];
+            }
+        }
+    }
+    for(int column = 0; column < width; ++column)
+    {
+        const quint32 * sum = sums.constData() + column * 4;
+        uchar * pixel = _out + column * 4;
+        const quint32 divisor = _is_premultiplied ? area : sum[3];
+        if(divisor == 0)
+        {
+            std::fill(pixel, pixel + 4, 0);
+            continue;
+        }
+        for(int channel = 0; channel < 3; ++channel)
+            pixel[channel] = static_cast<uchar>((sum[channel] + divisor / 2) / divisor);
+        pixel[3] = static_cast<uchar>((sum[3] + area / 2) / area);
+    }
+}
+
+} // namespace
+
+std::optional<QList<int>> parseAtlasScales(const QString & _scales)
+{
+    QList<int> scales;
+    for(const QString & item : _scales.split(',', Qt::SkipEmptyParts))
+    {
+        bool ok;
+        const int scale = item.trimmed().toInt(&ok);
+        if(!ok || scale <= 0)
+            return std::nullopt;
+        if(!scales.contains(scale))
+            scales.append(scale);
+    }
+    if(scales.isEmpty())
+        return std::nullopt;
+    std::sort(scales.begin(), scales.end());
+    const int max_scale = scales.last();
+    if(max_scale / scales.first() > g_max_atlas_scale)
+        return std::nullopt;
+    const bool is_divisible = std::all_of(scales.cbegin(), scales.cend(), [max_scale](int __scale) {
+        return max_scale % __scale == 0;
+    });
+    if(!is_divisible)
+        return std::nullopt;
+    return scales;
+}
+
+int atlasScaleLattice(const QList<int> & _scales)
+{
+    if(_scales.isEmpty())
+        return 1;
+    const int max_scale = *std::max_element(_scales.cbegin(), _scales.cend());
+    int lattice = 1;
+    for(int scale : _scales)
+        lattice = std::lcm(lattice, max_scale / scale);
+    return lattice;
+}
+
+QString scaledAtlasName(const QString & _atlas_name, int _scale)
+{
+    return QString("%1@%2x").arg(_atlas_name).arg(_scale);
+}
+
+QImage downscaleAtlasImage(const QImage & _image, int _factor)
+{
+    if(_factor <= 1 || _image.isNull())
+        return _image;
+    const bool is_premultiplied = _image.format() == QImage::Format_RGBA8888_Premultiplied;
+    const QImage image = is_premultiplied ? _image : normalizeSpriteImage(_image);
+    QImage result(divideUp(image.width(), _factor), divideUp(image.height(), _factor), image.format());
+    // Taken before the threads start, so that none of them detaches the image
+    uchar * out = result.bits();
+    const qsizetype out_stride = result.bytesPerLine();
+    QList<int> rows(result.height());
+    std::iota(rows.begin(), rows.end(), 0);
+    QtConcurrent::blockingMap(rows, [&](int __row) {
+        downscaleRow(image, __row, _factor, is_premultiplied, out + __row * out_stride);
+    });
+    return result;
+}
+
+std::unique_ptr<RawAtlasPack> downscaleAtlasPack(const RawAtlasPack & _pack, int _factor)
+{
+    std::unique_ptr<RawAtlasPack> pack = std::make_unique<RawAtlasPack>();
+    {
+        PackPhaseTimer timer(pack->statistics().phase(PackPhase::Downscale));
+        for(const RawAtlas & atlas : _pack)
+        {
+            // The grid is left out, the lattice keeps packers from laying sprites out in one
+            RawAtlas scaled;
+            scaled.image = downscaleAtlasImage(atlas.image, _factor);
+            scaled.frames.reserve(atlas.frames.count());
+            for(Frame frame : atlas.frames)
+            {
+                frame.texture_rect = downscaleRect(frame.texture_rect, _factor);
+                frame.sprite_rect = downscaleRect(frame.sprite_rect, _factor);
+                scaled.frames.append(frame);
+            }
+            scaled.content = analyzeTextureContent(scaled.image);
+            pack->add(std::move(scaled));
+        }
+    }
+    return pack;
+}
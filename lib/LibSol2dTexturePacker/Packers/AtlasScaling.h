@@ -0,0 +1,42 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/RawAtlasPack.h>
+#include <QList>
+#include <memory>
+#include <optional>
+
+// The largest scale an atlas is packed at relative to the smallest one
+constexpr int g_max_atlas_scale = 16;
+
+// Parses a comma separated list of scales, such as "1,2,4", and returns them in ascending order.
+// The sprites are drawn for the largest scale, which every other scale has to divide.
+S2TP_EXPORT std::optional<QList<int>> parseAtlasScales(const QString & _scales);
+// The lattice the sprites are aligned to, so that the layout divides by the factor of every scale
+S2TP_EXPORT int atlasScaleLattice(const QList<int> & _scales);
+S2TP_EXPORT QString scaledAtlasName(const QString & _atlas_name, int _scale);
+
+// Averages squares of the factor, pixels past the edges count as transparent. Colors of straight alpha images are
+// weighted by alpha, so that transparent pixels do not darken the edges. Rows are filtered on the global thread pool.
+S2TP_EXPORT QImage downscaleAtlasImage(const QImage & _image, int _factor);
+// Derives the pack at a smaller scale from a pack of sprites aligned to a lattice the factor divides.
+// The frames divide exactly and the pixels of the sprites never mix in the filter.
+// The statistics of the new pack only have the time of the downscale.
+S2TP_EXPORT std::unique_ptr<RawAtlasPack> downscaleAtlasPack(const RawAtlasPack & _pack, int _factor);
@@ -0,0 +1,537 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+#include <LibSol2dTexturePacker/Packers/BranchAndBoundAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/IndexedMaxRectsAlgorithm.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace {
+
+constexpr qint64 g_default_time_budget = 2000;
+constexpr int g_search_progress_range = 900;
+constexpr int g_progress_range = 1000;
+// The number of search nodes between two looks at the clock and the cancellation flag
+constexpr quint64 g_check_interval = 1024;
+// Before the exhaustive search, each width gets a short search that finds a good layout for it quickly
+constexpr quint64 g_probe_node_limit = 2048;
+
+// Unique sprites of the same size. When flipping is allowed, the size is stored lying on the long side.
+struct ItemType
+{
+    int width;
+    int height;
+    QList<qsizetype> unique_sprites;
+};
+
+struct Placement
+{
+    size_t type;
+    QRect rect;
+};
+
+struct Segment
+{
+    int x;
+    int y;
+    int width;
+};
+
+struct CandidateWidth
+{
+    int width;
+    qint64 area_bound;
+};
+
+class Search final
+{
+public:
+    Search(
+        std::vector<ItemType> _types,
+        const QSize & _max_size,
+        bool _allow_flip,
+        const QDeadlineTimer & _deadline,
+        const AtlasPackerContext & _context,
+        const std::function<void()> & _on_check);
+    void setSolution(std::vector<Placement> _placements, qint64 _area);
+    // Returns false when the search has been interrupted before it covered all widths
+    bool run();
+    const std::vector<ItemType> & types() const { return m_types; }
+    const std::vector<Placement> & solution() const { return m_solution; }
+    quint64 nodeCount() const { return m_node_count; }
+
+private:
+    int minHeight(int _width) const;
+    bool searchWidth(int _width, quint64 _node_limit);
+    bool branch(const std::vector<Segment> & _skyline, qint64 _waste, int _max_x, int _max_y);
+    static void placeOnSegment(std::vector<Segment> & _skyline, size_t _index, int _width, int _top);
+    static void mergeSegment(std::vector<Segment> & _skyline, size_t _index);
+
+private:
+    std::vector<ItemType> m_types;
+    QSize m_max_size;
+    bool m_allow_flip;
+    const QDeadlineTimer & m_deadline;
+    const AtlasPackerContext & m_context;
+    std::function<void()> m_on_check;
+    size_t m_item_count;
+    qint64 m_total_area;
+    int m_width;
+    std::vector<int> m_remaining;
+    std::vector<Placement> m_stack;
+    std::vector<Placement> m_solution;
+    qint64 m_solution_area;
+    quint64 m_node_count;
+    quint64 m_width_node_limit;
+    quint64 m_width_node_count;
+    bool m_is_interrupted;
+};
+
+Search::Search(
+    std::vector<ItemType> _types,
+    const QSize & _max_size,
+    bool _allow_flip,
+    const QDeadlineTimer & _deadline,
+    const AtlasPackerContext & _context,
+    const std::function<void()> & _on_check
+) :
+    m_types(std::move(_types)),
+    m_max_size(_max_size),
+    m_allow_flip(_allow_flip),
+    m_deadline(_deadline),
+    m_context(_context),
+    m_on_check(_on_check),
+    m_item_count(0),
+    m_total_area(0),
+    m_width(0),
+    m_solution_area(std::numeric_limits<qint64>::max()),
+    m_node_count(0),
+    m_width_node_limit(0),
+    m_width_node_count(0),
+    m_is_interrupted(false)
+{
+    // Large sprites first, so that good layouts are found early and bound the rest of the search
+    std::stable_sort(m_types.begin(), m_types.end(), [](const ItemType & __a, const ItemType & __b) {
+        return static_cast<qint64>(__a.width) * __a.height > static_cast<qint64>(__b.width) * __b.height;
+    });
+    m_remaining.reserve(m_types.size());
+    for(const ItemType & type : m_types)
+    {
+        m_remaining.push_back(static_cast<int>(type.unique_sprites.count()));
+        m_item_count += type.unique_sprites.count();
+        m_total_area += static_cast<qint64>(type.width) * type.height * type.unique_sprites.count();
+    }
+}
+
+void Search::setSolution(std::vector<Placement> _placements, qint64 _area)
+{
+    m_solution = std::move(_placements);
+    m_solution_area = _area;
+}
+
+bool Search::run()
+{
+    // Sprites are put at the left end of a segment, and the segments start where other sprites end,
+    // so the right edge of a layout is a sum of sprite sides
+    const int max_width = m_max_size.width();
+    std::vector<char> is_reachable(max_width + 1, 0);
+    is_reachable[0] = 1;
+    for(const ItemType & type : m_types)
+    {
+        for(qsizetype i = 0; i < type.unique_sprites.count(); ++i)
+        {
+            for(int sum = max_width; sum >= 0; --sum)
+            {
+                if(!is_reachable[sum])
+                    continue;
+                if(sum + type.width <= max_width)
+                    is_reachable[sum + type.width] = 1;
+                if(m_allow_flip && sum + type.height <= max_width)
+                    is_reachable[sum + type.height] = 1;
+            }
+        }
+    }
+    std::vector<CandidateWidth> widths;
+    for(int width = 1; width <= max_width; ++width)
+    {
+        if(!is_reachable[width])
+            continue;
+        const int height = minHeight(width);
+        if(height > 0 && height <= m_max_size.height())
+            widths.push_back({ .width = width, .area_bound = static_cast<qint64>(width) * height });
+    }
+    std::stable_sort(widths.begin(), widths.end(), [](const CandidateWidth & __a, const CandidateWidth & __b) {
+        return __a.area_bound < __b.area_bound;
+    });
+    for(const CandidateWidth & width : widths)
+    {
+        if(width.area_bound >= m_solution_area)
+            break;
+        searchWidth(width.width, g_probe_node_limit);
+        if(m_is_interrupted)
+            return false;
+    }
+    for(const CandidateWidth & width : widths)
+    {
+        if(width.area_bound >= m_solution_area)
+            break;
+        if(!searchWidth(width.width, std::numeric_limits<quint64>::max()))
+            return false;
+    }
+    return true;
+}
+
+// The lowest height of a layout of the given width, or -1 when a sprite is wider than the layout
+int Search::minHeight(int _width) const
+{
+    int height = static_cast<int>((m_total_area + _width - 1) / _width);
+    for(const ItemType & type : m_types)
+    {
+        int type_height = INT_MAX;
+        if(type.width <= _width)
+            type_height = type.height;
+        if(m_allow_flip && type.height <= _width)
+            type_height = std::min(type_height, type.width);
+        if(type_height == INT_MAX)
+            return -1;
+        height = std::max(height, type_height);
+    }
+    return height;
+}
+
+// Returns false when the search has been interrupted or has reached the node limit
+bool Search::searchWidth(int _width, quint64 _node_limit)
+{
+    m_width = _width;
+    m_width_node_limit = _node_limit;
+    m_width_node_count = 0;
+    const std::vector<Segment> skyline { { .x = 0, .y = 0, .width = _width } };
+    return branch(skyline, 0, 0, 0);
+}
+
+bool Search::branch(const std::vector<Segment> & _skyline, qint64 _waste, int _max_x, int _max_y)
+{
+    if(++m_width_node_count > m_width_node_limit)
+        return false;
+    if(++m_node_count % g_check_interval == 0)
+    {
+        if(m_deadline.hasExpired() || m_context.isCanceled())
+        {
+            m_is_interrupted = true;
+            return false;
+        }
+        m_on_check();
+    }
+    if(m_stack.size() == m_item_count)
+    {
+        const qint64 area = static_cast<qint64>(_max_x) * _max_y;
+        if(area < m_solution_area)
+        {
+            m_solution = m_stack;
+            m_solution_area = area;
+        }
+        return true;
+    }
+
+    // Sprites only go to the lowest segment, the leftmost one of equal segments
+    size_t lowest = 0;
+    for(size_t i = 1; i < _skyline.size(); ++i)
+    {
+        if(_skyline[i].y < _skyline[lowest].y)
+            lowest = i;
+    }
+    const Segment segment = _skyline[lowest];
+    int min_remaining_height = INT_MAX;
+    for(size_t t = 0; t < m_types.size(); ++t)
+    {
+        if(m_remaining[t] > 0)
+        {
+            // Types lie on their long side when flipping is allowed, so the height is the shortest side
+            min_remaining_height = std::min(min_remaining_height, m_types[t].height);
+        }
+    }
+    const int height_bound = std::max({
+        _max_y,
+        segment.y + min_remaining_height,
+        static_cast<int>((m_total_area + _waste + m_width - 1) / m_width)
+    });
+    if(static_cast<qint64>(m_width) * height_bound >= m_solution_area)
+        return true;
+
+    for(size_t t = 0; t < m_types.size(); ++t)
+    {
+        if(m_remaining[t] == 0)
+            continue;
+        const ItemType & type = m_types[t];
+        const int orientation_count = m_allow_flip && type.width != type.height ? 2 : 1;
+        for(int orientation = 0; orientation < orientation_count; ++orientation)
+        {
+            const int width = orientation == 0 ? type.width : type.height;
+            const int height = orientation == 0 ? type.height : type.width;
+            const int top = segment.y + height;
+            if(width > segment.width || top > m_max_size.height())
+                continue;
+            if(static_cast<qint64>(m_width) * std::max(_max_y, top) >= m_solution_area)
+                continue;
+            std::vector<Segment> skyline = _skyline;
+            placeOnSegment(skyline, lowest, width, top);
+            m_stack.push_back({ .type = t, .rect = QRect(segment.x, segment.y, width, height) });
+            --m_remaining[t];
+            const bool is_complete = branch(skyline, _waste, std::max(_max_x, segment.x + width), std::max(_max_y, top));
+            ++m_remaining[t];
+            m_stack.pop_back();
+            if(!is_complete)
+                return false;
+        }
+    }
+
+    // The segment may also stay empty up to the lower of its neighbours
+    if(_skyline.size() == 1)
+        return true;
+    int raised_y = INT_MAX;
+    if(lowest > 0)
+        raised_y = _skyline[lowest - 1].y;
+    if(lowest + 1 < _skyline.size())
+        raised_y = std::min(raised_y, _skyline[lowest + 1].y);
+    std::vector<Segment> skyline = _skyline;
+    skyline[lowest].y = raised_y;
+    mergeSegment(skyline, lowest);
+    return branch(skyline, _waste + static_cast<qint64>(segment.width) * (raised_y - segment.y), _max_x, _max_y);
+}
+
+void Search::placeOnSegment(std::vector<Segment> & _skyline, size_t _index, int _width, int _top)
+{
+    const Segment segment = _skyline[_index];
+    if(_width < segment.width)
+    {
+        _skyline.insert(
+            _skyline.begin() + static_cast<std::ptrdiff_t>(_index) + 1,
+            { .x = segment.x + _width, .y = segment.y, .width = segment.width - _width });
+    }
+    _skyline[_index].width = _width;
+    _skyline[_index].y = _top;
+    mergeSegment(_skyline, _index);
+}
+
+void Search::mergeSegment(std::vector<Segment> & _skyline, size_t _index)
+{
+    if(_index + 1 < _skyline.size() && _skyline[_index + 1].y == _skyline[_index].y)
+    {
+        _skyline[_index].width += _skyline[_index + 1].width;
+        _skyline.erase(_skyline.begin() + static_cast<std::ptrdiff_t>(_index) + 1);
+    }
+    if(_index > 0 && _skyline[_index - 1].y == _skyline[_index].y)
+    {
+        _skyline[_index - 1].width += _skyline[_index].width;
+        _skyline.erase(_skyline.begin() + static_cast<std::ptrdiff_t>(_index));
+    }
+}
+
+// Hands out the rectangles found by the search in the order of the placement
+class ReplayAlgorithm final : public AtlasPackerOnlineAlgorithm
+{
+public:
+    explicit ReplayAlgorithm(const QList<QRect> & _rects) :
+        m_rects(_rects),
+        m_next(0)
+    {
+    }
+
+    QRect insert(int _width, int _height) override
+    {
+        if(m_next >= m_rects.count() || m_rects[m_next].size() != QSize(_width, _height))
+            return QRect();
+        return m_rects[m_next++];
+    }
+
+    void resetBin() override
+    {
+    }
+
+private:
+    const QList<QRect> & m_rects;
+    qsizetype m_next;
+};
+
+class ReplayAtlasPacker final : public OnlineAlgorithmAtlasPacker
+{
+public:
+    explicit ReplayAtlasPacker(QList<QRect> _rects) :
+        OnlineAlgorithmAtlasPacker(nullptr),
+        m_rects(std::move(_rects))
+    {
+    }
+
+protected:
+    std::unique_ptr<AtlasPackerOnlineAlgorithm> createAlgorithm(const QSize & _max_atlas_size) const override
+    {
+        Q_UNUSED(_max_atlas_size)
+        return std::make_unique<ReplayAlgorithm>(m_rects);
+    }
+
+private:
+    QList<QRect> m_rects;
+};
+
+} // namespace
+
+BranchAndBoundAtlasPacker::BranchAndBoundAtlasPacker(QObject * _parent) :
+    AtlasPacker(_parent),
+    m_allow_flip(true),
+    m_time_budget(g_default_time_budget)
+{
+}
+
+std::unique_ptr<RawAtlasPack> BranchAndBoundAtlasPacker::pack(
+    AtlasPackerContext & _context,
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options) const
+{
+    _context.setProgressMaximum(g_progress_range);
+    PackStatistics search_statistics;
+    const QList<UniqueSprite> unique_sprites = collectUniqueSprites(_sprites, _options, _context, search_statistics);
+    if(_context.isCanceled())
+        return nullptr;
+
+    MaxRectsBinAtlasPacker fallback_packer;
+    fallback_packer.allowFlip(m_allow_flip);
+    const auto packFallback = [&]() -> std::unique_ptr<RawAtlasPack> {
+        AtlasPackerContext fallback_context(_context, g_search_progress_range, g_progress_range);
+        std::unique_ptr<RawAtlasPack> result = fallback_packer.pack(fallback_context, _sprites, _options);
+        if(result)
+            result->statistics().addPhases(search_statistics);
+        return result;
+    };
+
+    std::vector<ItemType> types;
+    {
+        std::map<std::pair<int, int>, size_t> type_indices;
+        for(qsizetype i = 0; i < unique_sprites.count(); ++i)
+        {
+            // The regular packer reports sprites that cannot be placed
+            if(unique_sprites[i].rect.isEmpty())
+                return packFallback();
+            const QSize cell = alignSpriteSize(unique_sprites[i].rect.size(), _options.block_size);
+            const std::pair<int, int> size = m_allow_flip
+                ? std::make_pair(std::max(cell.width(), cell.height()), std::min(cell.width(), cell.height()))
+                : std::make_pair(cell.width(), cell.height());
+            auto it = type_indices.find(size);
+            if(it == type_indices.end())
+            {
+                it = type_indices.emplace(size, types.size()).first;
+                types.push_back({ .width = size.first, .height = size.second, .unique_sprites = {} });
+            }
+            types[it->second].unique_sprites.append(i);
+        }
+    }
+
+    const QDeadlineTimer deadline = m_time_budget > 0
+        ? QDeadlineTimer(m_time_budget)
+        : QDeadlineTimer(QDeadlineTimer::Forever);
+    QElapsedTimer elapsed_timer;
+    elapsed_timer.start();
+    const auto updateProgress = [&]() {
+        if(m_time_budget > 0)
+        {
+            const qint64 progress = std::min(elapsed_timer.elapsed(), m_time_budget) * g_search_progress_range / m_time_budget;
+            _context.setProgressValue(static_cast<int>(progress));
+        }
+    };
+    const QSize bin_size = alignAtlasSize(_options.max_atlas_size, _options.block_size);
+    Search search(std::move(types), bin_size, m_allow_flip, deadline, _context, updateProgress);
+    bool is_optimal = false;
+    {
+        PackPhaseTimer timer(search_statistics.phase(PackPhase::Placement));
+        // MaxRects gives the first bound, the search only has to look at layouts smaller than it
+        std::vector<std::pair<size_t, qsizetype>> items;
+        for(size_t t = 0; t < search.types().size(); ++t)
+        {
+            for(qsizetype i = 0; i < search.types()[t].unique_sprites.count(); ++i)
+                items.emplace_back(t, i);
+        }
+        std::stable_sort(items.begin(), items.end(), [&search](const auto & __a, const auto & __b) {
+            const ItemType & a = search.types()[__a.first];
+            const ItemType & b = search.types()[__b.first];
+            return static_cast<qint64>(a.width) * a.height > static_cast<qint64>(b.width) * b.height;
+        });
+        IndexedMaxRectsAlgorithm algorithm(
+            bin_size,
+            MaxRectsBinAtlasPackerChoiceHeuristic::BestShortSideFit,
+            m_allow_flip);
+        std::vector<Placement> placements;
+        int max_x = 0;
+        int max_y = 0;
+        for(const auto & item : items)
+        {
+            const ItemType & type = search.types()[item.first];
+            const QRect rect = algorithm.insert(type.width, type.height);
+            if(rect.isNull())
+                break;
+            placements.push_back({ .type = item.first, .rect = rect });
+            max_x = std::max(max_x, rect.x() + rect.width());
+            max_y = std::max(max_y, rect.y() + rect.height());
+        }
+        if(placements.size() == items.size())
+            search.setSolution(std::move(placements), static_cast<qint64>(max_x) * max_y);
+        is_optimal = search.run();
+        search_statistics.trial_count = static_cast<qsizetype>(search.nodeCount());
+    }
+    if(_context.isCanceled())
+        return nullptr;
+    // The sprites do not fit into one atlas
+    if(search.solution().empty() && !unique_sprites.isEmpty())
+        return packFallback();
+
+    SpritePlacementOrder order;
+    order.indices.reserve(_sprites.count());
+    order.rotations.fill(false, _sprites.count());
+    QList<QRect> rects;
+    rects.reserve(unique_sprites.count());
+    std::vector<qsizetype> next_sprites(search.types().size(), 0);
+    for(const Placement & placement : search.solution())
+    {
+        const ItemType & type = search.types()[placement.type];
+        const UniqueSprite & sprite = unique_sprites[type.unique_sprites[next_sprites[placement.type]++]];
+        const QSize cell = alignSpriteSize(sprite.rect.size(), _options.block_size);
+        const bool is_rotated = placement.rect.width() != cell.width();
+        rects.append(placement.rect);
+        order.rotations[order.indices.count()] = is_rotated;
+        order.indices.append(sprite.index);
+        for(qsizetype duplicate : sprite.duplicates)
+        {
+            order.rotations[order.indices.count()] = is_rotated;
+            order.indices.append(duplicate);
+        }
+    }
+    ReplayAtlasPacker packer(std::move(rects));
+    AtlasPackerContext final_context(_context, g_search_progress_range, g_progress_range);
+    std::unique_ptr<RawAtlasPack> result = packer.pack(final_context, _sprites, _options, order);
+    if(!result)
+        return nullptr;
+    result->statistics().addPhases(search_statistics);
+    result->statistics().trial_count = search_statistics.trial_count;
+    result->statistics().is_optimal = is_optimal;
+    _context.setProgressValue(g_progress_range);
+    return result;
+}
@@ -0,0 +1,45 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
+
+// Finds the single atlas with the smallest area for a small set of sprites. The branch and bound search puts
+// a sprite at the left end of the lowest skyline segment or gives the segment up as waste, so it is exact among
+// bottom-left packings. Sprites of the same size are interchangeable and are only tried in one order.
+// When the time budget runs out, the best layout found so far is used. Sprites that do not fit into one atlas
+// are packed by MaxRects.
+class S2TP_EXPORT BranchAndBoundAtlasPacker final : public AtlasPacker
+{
+public:
+    explicit BranchAndBoundAtlasPacker(QObject * _parent = nullptr);
+    void allowFlip(bool _allow) { m_allow_flip = _allow; }
+    bool isFlipAllowed() const { return m_allow_flip; }
+    // Zero means no limit
+    void setTimeBudget(qint64 _milliseconds) { m_time_budget = _milliseconds; }
+    qint64 timeBudget() const { return m_time_budget; }
+
+    std::unique_ptr<RawAtlasPack> pack(
+        AtlasPackerContext & _context,
+        const QList<Sprite> & _sprites,
+        const AtlasPackerOptions & _options) const override;
+
+private:
+    bool m_allow_flip;
+    qint64 m_time_budget;
+};
@@ -0,0 +1,434 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/BucketedGuillotineAlgorithm.h>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+quint64 cornerKey(int _x, int _y)
+{
+    return (static_cast<quint64>(static_cast<quint32>(_x)) << 32) | static_cast<quint32>(_y);
+}
+
+int sizeClass(int _size)
+{
+    return static_cast<int>(std::bit_width(static_cast<unsigned>(std::max(0, _size))));
+}
+
+int minSizeOfClass(int _class)
+{
+    return _class == 0 ? 0 : 1 << (_class - 1);
+}
+
+int maxSizeOfClass(int _class)
+{
+    return (1 << _class) - 1;
+}
+
+} // namespace
+
+BucketedGuillotineAlgorithm::BucketedGuillotineAlgorithm(
+    const QSize & _bin_size,
+    GuillotineBinAtlasPackerChoiceHeuristic _choice_heuristic,
+    GuillotineBinAtlasPackerSplitHeuristic _split_heuristic,
+    bool _is_merge_enabled
+) :
+    m_bin_size(_bin_size),
+    m_choice_heuristic(_choice_heuristic),
+    m_split_heuristic(_split_heuristic),
+    m_is_merge_enabled(_is_merge_enabled),
+    m_class_count(0),
+    m_next_key(0)
+{
+    resetBin();
+}
+
+void BucketedGuillotineAlgorithm::resetBin()
+{
+    m_class_count = sizeClass(std::max(m_bin_size.width(), m_bin_size.height())) + 1;
+    m_next_key = 0;
+    m_slots.clear();
+    m_unused_slots.clear();
+    m_buckets.assign(static_cast<size_t>(m_class_count) * m_class_count, std::vector<int>());
+    m_by_top_left.clear();
+    m_by_top_right.clear();
+    m_by_bottom_left.clear();
+    m_merge_candidates.clear();
+    addFreeRect({ 0, 0, m_bin_size.width(), m_bin_size.height() });
+}
+
+QRect BucketedGuillotineAlgorithm::insert(int _width, int _height)
+{
+    const Choice choice = findPosition(_width, _height);
+    if(choice.slot < 0)
+        return QRect();
+    const Rect free_rect = m_slots[choice.slot].rect;
+    // The chosen rectangle overlaps the new ones, so it leaves the corner index first
+    removeFreeRect(choice.slot);
+    splitFreeRect(free_rect, choice.rect);
+    if(m_is_merge_enabled)
+        mergeFreeRects();
+    return QRect(choice.rect.x, choice.rect.y, choice.rect.width, choice.rect.height);
+}
+
+BucketedGuillotineAlgorithm::Choice BucketedGuillotineAlgorithm::findPosition(int _width, int _height) const
+{
+    Choice choice { .rect = { 0, 0, 0, 0 }, .slot = -1 };
+    // rbp takes the first perfect fit regardless of the scores of the rectangles before it
+    if(findPerfectFit(_width, _height, choice))
+        return choice;
+
+    std::vector<std::pair<qint64, int>> buckets;
+    for(int width_class = 1; width_class < m_class_count; ++width_class)
+    {
+        const int max_width = maxSizeOfClass(width_class);
+        for(int height_class = 1; height_class < m_class_count; ++height_class)
+        {
+            const int bucket = bucketIndex(width_class, height_class);
+            if(m_buckets[bucket].empty())
+                continue;
+            const int max_height = maxSizeOfClass(height_class);
+            if((max_width >= _width && max_height >= _height) || (max_width >= _height && max_height >= _width))
+                buckets.emplace_back(bucketBound(width_class, height_class, _width, _height), bucket);
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+
+    qint64 best_score = std::numeric_limits<qint64>::max();
+    qint64 best_key = std::numeric_limits<qint64>::max();
+    for(const auto & [bound, bucket] : buckets)
+    {
+        // Ties are broken by the position in the list, so a bucket that can only tie is still scanned
+        if(bound > best_score)
+            break;
+        for(int slot : m_buckets[bucket])
+        {
+            const FreeRect & free_rect = m_slots[slot];
+            const Rect & rect = free_rect.rect;
+            Rect node;
+            int node_score;
+            if(_width <= rect.width && _height <= rect.height)
+            {
+                node = { rect.x, rect.y, _width, _height };
+                node_score = score(_width, _height, rect);
+            }
+            else if(_height <= rect.width && _width <= rect.height)
+            {
+                node = { rect.x, rect.y, _height, _width };
+                node_score = score(_height, _width, rect);
+            }
+            else
+            {
+                continue;
+            }
+            if(node_score < best_score || (node_score == best_score && free_rect.key < best_key))
+            {
+                best_score = node_score;
+                best_key = free_rect.key;
+                choice = { .rect = node, .slot = slot };
+            }
+        }
+    }
+    return choice;
+}
+
+bool BucketedGuillotineAlgorithm::findPerfectFit(int _width, int _height, Choice & _choice) const
+{
+    qint64 best_key = std::numeric_limits<qint64>::max();
+    const auto scan = [&](int __bucket) {
+        for(int slot : m_buckets[__bucket])
+        {
+            const FreeRect & free_rect = m_slots[slot];
+            const Rect & rect = free_rect.rect;
+            if(free_rect.key > best_key)
+                continue;
+            if(rect.width == _width && rect.height == _height)
+                _choice = { .rect = { rect.x, rect.y, _width, _height }, .slot = slot };
+            else if(rect.width == _height && rect.height == _width)
+                _choice = { .rect = { rect.x, rect.y, _height, _width }, .slot = slot };
+            else
+                continue;
+            best_key = free_rect.key;
+        }
+    };
+    const int width_class = sizeClass(_width);
+    const int height_class = sizeClass(_height);
+    if(width_class >= m_class_count || height_class >= m_class_count)
+        return false;
+    scan(bucketIndex(width_class, height_class));
+    if(width_class != height_class)
+        scan(bucketIndex(height_class, width_class));
+    return _choice.slot >= 0;
+}
+
+int BucketedGuillotineAlgorithm::score(int _width, int _height, const Rect & _free_rect) const
+{
+    const int leftover_horizontal = std::abs(_free_rect.width - _width);
+    const int leftover_vertical = std::abs(_free_rect.height - _height);
+    const int area_fit = _free_rect.width * _free_rect.height - _width * _height;
+    switch(m_choice_heuristic)
+    {
+    case GuillotineBinAtlasPackerChoiceHeuristic::BestAreaFit:
+        return area_fit;
+    case GuillotineBinAtlasPackerChoiceHeuristic::BestShortSideFit:
+        return std::min(leftover_horizontal, leftover_vertical);
+    case GuillotineBinAtlasPackerChoiceHeuristic::BestLongSideFit:
+        return std::max(leftover_horizontal, leftover_vertical);
+    case GuillotineBinAtlasPackerChoiceHeuristic::WorstAreaFit:
+        return -area_fit;
+    case GuillotineBinAtlasPackerChoiceHeuristic::WorstShortSideFit:
+        return -std::min(leftover_horizontal, leftover_vertical);
+    case GuillotineBinAtlasPackerChoiceHeuristic::WorstLongSideFit:
+        return -std::max(leftover_horizontal, leftover_vertical);
+    default:
+        throw std::runtime_error("Unknown GuillotineBinAtlasPackerChoiceHeuristic");
+    }
+}
+
+qint64 BucketedGuillotineAlgorithm::bucketBound(int _width_class, int _height_class, int _width, int _height) const
+{
+    const qint64 min_width = minSizeOfClass(_width_class);
+    const qint64 max_width = maxSizeOfClass(_width_class);
+    const qint64 min_height = minSizeOfClass(_height_class);
+    const qint64 max_height = maxSizeOfClass(_height_class);
+    // The lowest score a rectangle of the bucket can have with the sprite in the given orientation
+    const auto bound = [&](qint64 __width, qint64 __height) -> qint64 {
+        if(max_width < __width || max_height < __height)
+            return std::numeric_limits<qint64>::max();
+        const qint64 min_leftover_horizontal = std::max<qint64>(min_width - __width, 0);
+        const qint64 min_leftover_vertical = std::max<qint64>(min_height - __height, 0);
+        const qint64 max_leftover_horizontal = max_width - __width;
+        const qint64 max_leftover_vertical = max_height - __height;
+        switch(m_choice_heuristic)
+        {
+        case GuillotineBinAtlasPackerChoiceHeuristic::BestAreaFit:
+            return std::max(min_width, __width) * std::max(min_height, __height) - __width * __height;
+        case GuillotineBinAtlasPackerChoiceHeuristic::BestShortSideFit:
+            return std::min(min_leftover_horizontal, min_leftover_vertical);
+        case GuillotineBinAtlasPackerChoiceHeuristic::BestLongSideFit:
+            return std::max(min_leftover_horizontal, min_leftover_vertical);
+        case GuillotineBinAtlasPackerChoiceHeuristic::WorstAreaFit:
+            return __width * __height - max_width * max_height;
+        case GuillotineBinAtlasPackerChoiceHeuristic::WorstShortSideFit:
+            return -std::min(max_leftover_horizontal, max_leftover_vertical);
+        case GuillotineBinAtlasPackerChoiceHeuristic::WorstLongSideFit:
+            return -std::max(max_leftover_horizontal, max_leftover_vertical);
+        default:
+            throw std::runtime_error("Unknown GuillotineBinAtlasPackerChoiceHeuristic");
+        }
+    };
+    return std::min(bound(_width, _height), bound(_height, _width));
+}
+
+void BucketedGuillotineAlgorithm::splitFreeRect(const Rect & _free_rect, const Rect & _placed_rect)
+{
+    const int leftover_width = _free_rect.width - _placed_rect.width;
+    const int leftover_height = _free_rect.height - _placed_rect.height;
+    bool is_horizontal;
+    switch(m_split_heuristic)
+    {
+    case GuillotineBinAtlasPackerSplitHeuristic::ShorterLeftoverAxis:
+        is_horizontal = leftover_width <= leftover_height;
+        break;
+    case GuillotineBinAtlasPackerSplitHeuristic::LongerLeftoverAxis:
+        is_horizontal = leftover_width > leftover_height;
+        break;
+    case GuillotineBinAtlasPackerSplitHeuristic::MinimizeArea:
+        is_horizontal = _placed_rect.width * leftover_height > leftover_width * _placed_rect.height;
+        break;
+    case GuillotineBinAtlasPackerSplitHeuristic::MaximizeArea:
+        is_horizontal = _placed_rect.width * leftover_height <= leftover_width * _placed_rect.height;
+        break;
+    case GuillotineBinAtlasPackerSplitHeuristic::ShorterAxis:
+        is_horizontal = _free_rect.width <= _free_rect.height;
+        break;
+    case GuillotineBinAtlasPackerSplitHeuristic::LongerAxis:
+        is_horizontal = _free_rect.width > _free_rect.height;
+        break;
+    default:
+        throw std::runtime_error("Unknown GuillotineBinAtlasPackerSplitHeuristic");
+    }
+
+    const Rect bottom
+    {
+        .x = _free_rect.x,
+        .y = _free_rect.y + _placed_rect.height,
+        .width = is_horizontal ? _free_rect.width : _placed_rect.width,
+        .height = leftover_height
+    };
+    const Rect right
+    {
+        .x = _free_rect.x + _placed_rect.width,
+        .y = _free_rect.y,
+        .width = leftover_width,
+        .height = is_horizontal ? _placed_rect.height : _free_rect.height
+    };
+    if(bottom.width > 0 && bottom.height > 0)
+        addFreeRect(bottom);
+    if(right.width > 0 && right.height > 0)
+        addFreeRect(right);
+}
+
+void BucketedGuillotineAlgorithm::mergeFreeRects()
+{
+    // rbp walks the list once and merges each rectangle with the following ones in order. A rectangle
+    // only has to be visited when it has a neighbour to merge with, and the visits go in list order.
+    std::vector<MergeCandidate> candidates;
+    candidates.swap(m_merge_candidates);
+    std::make_heap(candidates.begin(), candidates.end(), std::greater<MergeCandidate>());
+    qint64 last_key = -1;
+    while(!candidates.empty())
+    {
+        std::pop_heap(candidates.begin(), candidates.end(), std::greater<MergeCandidate>());
+        const auto [key, slot] = candidates.back();
+        candidates.pop_back();
+        if(key == last_key || m_slots[slot].bucket < 0 || m_slots[slot].key != key)
+            continue;
+        last_key = key;
+        qint64 scanned_key = key;
+        bool is_merged = false;
+        for(int neighbour; (neighbour = findMergeNeighbour(slot, scanned_key)) >= 0;)
+        {
+            const Rect & a = m_slots[slot].rect;
+            const Rect & b = m_slots[neighbour].rect;
+            const Rect merged
+            {
+                .x = std::min(a.x, b.x),
+                .y = std::min(a.y, b.y),
+                .width = a.y == b.y ? a.width + b.width : a.width,
+                .height = a.x == b.x ? a.height + b.height : a.height
+            };
+            scanned_key = m_slots[neighbour].key;
+            removeFreeRect(neighbour);
+            unlink(slot);
+            m_slots[slot].rect = merged;
+            link(slot);
+            is_merged = true;
+        }
+        // Neighbours the walk has already gone past are merged by the walk after the next insertion
+        if(is_merged)
+            addMergeCandidates(slot);
+    }
+}
+
+int BucketedGuillotineAlgorithm::findMergeNeighbour(int _slot, qint64 _min_key) const
+{
+    const Rect & rect = m_slots[_slot].rect;
+    int result = -1;
+    qint64 result_key = std::numeric_limits<qint64>::max();
+    const auto check = [&](const std::unordered_map<quint64, int> & __index, int __x, int __y, bool __is_vertical) {
+        auto it = __index.find(cornerKey(__x, __y));
+        if(it == __index.end())
+            return;
+        const FreeRect & neighbour = m_slots[it->second];
+        const bool is_mergeable = __is_vertical
+            ? neighbour.rect.width == rect.width
+            : neighbour.rect.height == rect.height;
+        if(is_mergeable && neighbour.key > _min_key && neighbour.key < result_key)
+        {
+            result = it->second;
+            result_key = neighbour.key;
+        }
+    };
+    check(m_by_top_left, rect.x, rect.y + rect.height, true);
+    check(m_by_bottom_left, rect.x, rect.y, true);
+    check(m_by_top_left, rect.x + rect.width, rect.y, false);
+    check(m_by_top_right, rect.x, rect.y, false);
+    return result;
+}
+
+void BucketedGuillotineAlgorithm::addMergeCandidates(int _slot)
+{
+    const qint64 key = m_slots[_slot].key;
+    for(qint64 min_key = -1;;)
+    {
+        const int neighbour = findMergeNeighbour(_slot, min_key);
+        if(neighbour < 0)
+            break;
+        min_key = m_slots[neighbour].key;
+        if(min_key < key)
+            m_merge_candidates.emplace_back(min_key, neighbour);
+        else
+            m_merge_candidates.emplace_back(key, _slot);
+    }
+}
+
+int BucketedGuillotineAlgorithm::addFreeRect(const Rect & _rect)
+{
+    int slot;
+    if(m_unused_slots.empty())
+    {
+        slot = static_cast<int>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    else
+    {
+        slot = m_unused_slots.back();
+        m_unused_slots.pop_back();
+    }
+    m_slots[slot] = { .rect = _rect, .key = m_next_key++, .bucket = -1, .bucket_position = -1 };
+    link(slot);
+    if(m_is_merge_enabled)
+        addMergeCandidates(slot);
+    return slot;
+}
+
+void BucketedGuillotineAlgorithm::removeFreeRect(int _slot)
+{
+    unlink(_slot);
+    m_unused_slots.push_back(_slot);
+}
+
+void BucketedGuillotineAlgorithm::link(int _slot)
+{
+    FreeRect & free_rect = m_slots[_slot];
+    const Rect & rect = free_rect.rect;
+    free_rect.bucket = bucketIndex(sizeClass(rect.width), sizeClass(rect.height));
+    std::vector<int> & bucket = m_buckets[free_rect.bucket];
+    free_rect.bucket_position = static_cast<int>(bucket.size());
+    bucket.push_back(_slot);
+    if(m_is_merge_enabled)
+    {
+        m_by_top_left[cornerKey(rect.x, rect.y)] = _slot;
+        m_by_top_right[cornerKey(rect.x + rect.width, rect.y)] = _slot;
+        m_by_bottom_left[cornerKey(rect.x, rect.y + rect.height)] = _slot;
+    }
+}
+
+void BucketedGuillotineAlgorithm::unlink(int _slot)
+{
+    FreeRect & free_rect = m_slots[_slot];
+    const Rect & rect = free_rect.rect;
+    std::vector<int> & bucket = m_buckets[free_rect.bucket];
+    const int moved_slot = bucket.back();
+    bucket[free_rect.bucket_position] = moved_slot;
+    m_slots[moved_slot].bucket_position = free_rect.bucket_position;
+    bucket.pop_back();
+    free_rect.bucket = -1;
+    if(m_is_merge_enabled)
+    {
+        m_by_top_left.erase(cornerKey(rect.x, rect.y));
+        m_by_top_right.erase(cornerKey(rect.x + rect.width, rect.y));
+        m_by_bottom_left.erase(cornerKey(rect.x, rect.y + rect.height));
+    }
+}
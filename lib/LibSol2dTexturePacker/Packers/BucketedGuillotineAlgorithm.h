@@ -0,0 +1,98 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/GuillotineBinAtlaskPacker.h>
+#include <unordered_map>
+#include <vector>
+
+// Guillotine with the choice and split heuristics, scores and tie-breaking of rbp::GuillotineBinPack.
+// Free rectangles are bucketed by the magnitude of their sides, so the choice only scans buckets that can
+// beat the best score found so far. Merging looks up the exact neighbours of changed rectangles by their
+// corners instead of comparing every pair, and repeats the merges of rbp's single pass over the free list.
+class S2TP_EXPORT BucketedGuillotineAlgorithm final : public AtlasPackerOnlineAlgorithm
+{
+private:
+    struct Rect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct FreeRect
+    {
+        Rect rect;
+        // The position in rbp's free list, the list keeps the order of insertion
+        qint64 key;
+        // -1 when the slot is not used
+        int bucket;
+        int bucket_position;
+    };
+
+    struct Choice
+    {
+        Rect rect;
+        int slot;
+    };
+
+    // The key and the slot of a free rectangle that may have a neighbour to merge with further in the list
+    typedef std::pair<qint64, int> MergeCandidate;
+
+public:
+    BucketedGuillotineAlgorithm(
+        const QSize & _bin_size,
+        GuillotineBinAtlasPackerChoiceHeuristic _choice_heuristic,
+        GuillotineBinAtlasPackerSplitHeuristic _split_heuristic,
+        bool _is_merge_enabled);
+    QRect insert(int _width, int _height) override;
+    void resetBin() override;
+
+private:
+    Choice findPosition(int _width, int _height) const;
+    bool findPerfectFit(int _width, int _height, Choice & _choice) const;
+    int score(int _width, int _height, const Rect & _free_rect) const;
+    qint64 bucketBound(int _width_class, int _height_class, int _width, int _height) const;
+    void splitFreeRect(const Rect & _free_rect, const Rect & _placed_rect);
+    void mergeFreeRects();
+    int findMergeNeighbour(int _slot, qint64 _min_key) const;
+    void addMergeCandidates(int _slot);
+    int addFreeRect(const Rect & _rect);
+    void removeFreeRect(int _slot);
+    void link(int _slot);
+    void unlink(int _slot);
+    int bucketIndex(int _width_class, int _height_class) const { return _width_class * m_class_count + _height_class; }
+
+private:
+    QSize m_bin_size;
+    GuillotineBinAtlasPackerChoiceHeuristic m_choice_heuristic;
+    GuillotineBinAtlasPackerSplitHeuristic m_split_heuristic;
+    bool m_is_merge_enabled;
+    int m_class_count;
+    qint64 m_next_key;
+    std::vector<FreeRect> m_slots;
+    std::vector<int> m_unused_slots;
+    // Slots of free rectangles by the bit widths of their width and height
+    std::vector<std::vector<int>> m_buckets;
+    // Free rectangles are disjoint, so each corner identifies at most one of them
+    std::unordered_map<quint64, int> m_by_top_left;
+    std::unordered_map<quint64, int> m_by_top_right;
+    std::unordered_map<quint64, int> m_by_bottom_left;
+    std::vector<MergeCandidate> m_merge_candidates;
+};
@@ -17,14 +17,15 @@
  **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Packers/GuillotineBinAtlaskPacker.h>
+#include <LibSol2dTexturePacker/Packers/BucketedGuillotineAlgorithm.h>
 #include <RectangleBinPack/GuillotineBinPack.h>
 
 namespace {
 
-class GuillotineBinPackAlgorithm : public AtlasPackerOnlineAlgorithm
+class RbpGuillotineBinPackAlgorithm : public AtlasPackerOnlineAlgorithm
 {
 public:
-    GuillotineBinPackAlgorithm(
+    RbpGuillotineBinPackAlgorithm(
         const QSize & _max_atlas_size,
         GuillotineBinAtlasPackerChoiceHeuristic _choice_heuristic,
         GuillotineBinAtlasPackerSplitHeuristic _split_heuristic,
@@ -44,7 +45,7 @@ private:
     bool m_is_merge_enabled;
 };
 
-GuillotineBinPackAlgorithm::GuillotineBinPackAlgorithm(
+RbpGuillotineBinPackAlgorithm::RbpGuillotineBinPackAlgorithm(
     const QSize & _max_atlas_size,
     GuillotineBinAtlasPackerChoiceHeuristic _choice_heuristic,
     GuillotineBinAtlasPackerSplitHeuristic _split_heuristic,
@@ -58,7 +59,7 @@ GuillotineBinPackAlgorithm::GuillotineBinPackAlgorithm(
 {
 }
 
-rbp::GuillotineBinPack::FreeRectChoiceHeuristic GuillotineBinPackAlgorithm::map(
+rbp::GuillotineBinPack::FreeRectChoiceHeuristic RbpGuillotineBinPackAlgorithm::map(
     GuillotineBinAtlasPackerChoiceHeuristic _heuristic)
 {
     switch(_heuristic)
@@ -80,7 +81,7 @@ rbp::GuillotineBinPack::FreeRectChoiceHeuristic GuillotineBinPackAlgorithm::map(
     }
 }
 
-rbp::GuillotineBinPack::GuillotineSplitHeuristic GuillotineBinPackAlgorithm::map(
+rbp::GuillotineBinPack::GuillotineSplitHeuristic RbpGuillotineBinPackAlgorithm::map(
     GuillotineBinAtlasPackerSplitHeuristic _heuristic)
 {
     switch(_heuristic)
@@ -102,13 +103,13 @@ rbp::GuillotineBinPack::GuillotineSplitHeuristic GuillotineBinPackAlgorithm::map
     }
 }
 
-QRect GuillotineBinPackAlgorithm::insert(int _width, int _height)
+QRect RbpGuillotineBinPackAlgorithm::insert(int _width, int _height)
 {
     rbp::Rect rect = m_pack.Insert(_width, _height, m_is_merge_enabled, m_choice_heuristic, m_split_heuristic);
     return QRect(rect.x, rect.y, rect.width, rect.height);
 }
 
-void GuillotineBinPackAlgorithm::resetBin()
+void RbpGuillotineBinPackAlgorithm::resetBin()
 {
     m_pack.Init(m_max_atlas_size.width(), m_max_atlas_size.height());
 }
@@ -125,6 +126,14 @@ GuillotineBinAtlaskPacker::GuillotineBinAtlaskPacker(QObject * _parent) :
 
 std::unique_ptr<AtlasPackerOnlineAlgorithm> GuillotineBinAtlaskPacker::createAlgorithm(const QSize & _max_atlas_size) const
 {
+    if(m_engine == OnlineAlgorithmEngine::Native)
+    {
+        return std::make_unique<BucketedGuillotineAlgorithm>(
+            _max_atlas_size,
+            m_choice_heuristic,
+            m_split_heuristic,
+            m_is_merge_enabled);
+    }
     return std::unique_ptr<AtlasPackerOnlineAlgorithm>(
-        new GuillotineBinPackAlgorithm(_max_atlas_size, m_choice_heuristic, m_split_heuristic, m_is_merge_enabled));
+        new RbpGuillotineBinPackAlgorithm(_max_atlas_size, m_choice_heuristic, m_split_heuristic, m_is_merge_enabled));
 }
@@ -0,0 +1,520 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/IndexedMaxRectsAlgorithm.h>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// The grid has at most this number of cells on each side
+constexpr int g_grid_resolution = 32;
+constexpr int g_min_cell_size = 8;
+
+template<typename RectType>
+bool isContainedIn(const RectType & _a, const RectType & _b)
+{
+    return
+        _a.x >= _b.x && _a.y >= _b.y &&
+        _a.x + _a.width <= _b.x + _b.width &&
+        _a.y + _a.height <= _b.y + _b.height;
+}
+
+template<typename RectType>
+bool intersects(const RectType & _a, const RectType & _b)
+{
+    return !(
+        _a.x >= _b.x + _b.width || _a.x + _a.width <= _b.x ||
+        _a.y >= _b.y + _b.height || _a.y + _a.height <= _b.y);
+}
+
+int commonIntervalLength(int _i1_start, int _i1_end, int _i2_start, int _i2_end)
+{
+    if(_i1_end < _i2_start || _i2_end < _i1_start)
+        return 0;
+    return std::min(_i1_end, _i2_end) - std::max(_i1_start, _i2_start);
+}
+
+} // namespace
+
+void IndexedMaxRectsAlgorithm::Grid::reset(const QSize & _bin_size)
+{
+    const int max_side = std::max(_bin_size.width(), _bin_size.height());
+    cell_size = std::max(g_min_cell_size, (max_side + g_grid_resolution - 1) / g_grid_resolution);
+    columns = std::max(1, (_bin_size.width() + cell_size - 1) / cell_size);
+    rows = std::max(1, (_bin_size.height() + cell_size - 1) / cell_size);
+    cells.assign(static_cast<size_t>(columns) * rows, std::vector<int>());
+}
+
+std::vector<int> & IndexedMaxRectsAlgorithm::Grid::cellAt(int _x, int _y)
+{
+    const int column = std::clamp(_x / cell_size, 0, columns - 1);
+    const int row = std::clamp(_y / cell_size, 0, rows - 1);
+    return cells[static_cast<size_t>(row) * columns + column];
+}
+
+template<typename Callback>
+void IndexedMaxRectsAlgorithm::Grid::forEachCell(const Rect & _rect, Callback _callback)
+{
+    const int first_column = std::clamp(_rect.x / cell_size, 0, columns - 1);
+    const int last_column = std::clamp((_rect.x + _rect.width - 1) / cell_size, 0, columns - 1);
+    const int first_row = std::clamp(_rect.y / cell_size, 0, rows - 1);
+    const int last_row = std::clamp((_rect.y + _rect.height - 1) / cell_size, 0, rows - 1);
+    for(int row = first_row; row <= last_row; ++row)
+    {
+        for(int column = first_column; column <= last_column; ++column)
+            _callback(cells[static_cast<size_t>(row) * columns + column]);
+    }
+}
+
+void IndexedMaxRectsAlgorithm::Grid::add(int _id, const Rect & _rect)
+{
+    forEachCell(_rect, [_id](std::vector<int> & __cell) { __cell.push_back(_id); });
+}
+
+IndexedMaxRectsAlgorithm::IndexedMaxRectsAlgorithm(
+    const QSize & _bin_size,
+    MaxRectsBinAtlasPackerChoiceHeuristic _heuristic,
+    bool _allow_flip
+) :
+    m_bin_size(_bin_size),
+    m_heuristic(_heuristic),
+    m_allow_flip(_allow_flip),
+    m_new_free_rects_last_size(0),
+    m_stamp(0)
+{
+    resetBin();
+}
+
+void IndexedMaxRectsAlgorithm::resetBin()
+{
+    m_free_rects.clear();
+    m_positions.clear();
+    m_free_stamps.clear();
+    m_free_grid.reset(m_bin_size);
+    m_new_free_rects.clear();
+    m_new_free_rects_last_size = 0;
+    m_used_rects.clear();
+    m_used_stamps.clear();
+    if(m_heuristic == MaxRectsBinAtlasPackerChoiceHeuristic::ContactPointRule)
+        m_used_grid.reset(m_bin_size);
+    m_stamp = 0;
+    addFreeRectangle({ 0, 0, m_bin_size.width(), m_bin_size.height() });
+}
+
+QRect IndexedMaxRectsAlgorithm::insert(int _width, int _height)
+{
+    Rect node;
+    switch(m_heuristic)
+    {
+    case MaxRectsBinAtlasPackerChoiceHeuristic::BestShortSideFit:
+        node = findPositionBestShortSideFit(_width, _height);
+        break;
+    case MaxRectsBinAtlasPackerChoiceHeuristic::BottomLeftRule:
+        node = findPositionBottomLeft(_width, _height);
+        break;
+    case MaxRectsBinAtlasPackerChoiceHeuristic::ContactPointRule:
+        node = findPositionContactPoint(_width, _height);
+        break;
+    case MaxRectsBinAtlasPackerChoiceHeuristic::BestLongSideFit:
+        node = findPositionBestLongSideFit(_width, _height);
+        break;
+    case MaxRectsBinAtlasPackerChoiceHeuristic::BestAreaFit:
+        node = findPositionBestAreaFit(_width, _height);
+        break;
+    default:
+        throw std::runtime_error("Unknown MaxRectsBinAtlasPackerChoiceHeuristic");
+    }
+    if(node.height == 0)
+        return QRect();
+    placeRect(node);
+    return QRect(node.x, node.y, node.width, node.height);
+}
+
+IndexedMaxRectsAlgorithm::Rect IndexedMaxRectsAlgorithm::findPositionBottomLeft(int _width, int _height) const
+{
+    Rect best_node { 0, 0, 0, 0 };
+    int best_y = std::numeric_limits<int>::max();
+    int best_x = std::numeric_limits<int>::max();
+    for(const FreeRect & free_rect : m_free_rects)
+    {
+        const Rect & rect = free_rect.rect;
+        if(rect.width >= _width && rect.height >= _height)
+        {
+            const int top_side_y = rect.y + _height;
+            if(top_side_y < best_y || (top_side_y == best_y && rect.x < best_x))
+            {
+                best_node = { rect.x, rect.y, _width, _height };
+                best_y = top_side_y;
+                best_x = rect.x;
+            }
+        }
+        if(m_allow_flip && rect.width >= _height && rect.height >= _width)
+        {
+            const int top_side_y = rect.y + _width;
+            if(top_side_y < best_y || (top_side_y == best_y && rect.x < best_x))
+            {
+                best_node = { rect.x, rect.y, _height, _width };
+                best_y = top_side_y;
+                best_x = rect.x;
+            }
+        }
+    }
+    return best_node;
+}
+
+IndexedMaxRectsAlgorithm::Rect IndexedMaxRectsAlgorithm::findPositionBestShortSideFit(int _width, int _height) const
+{
+    Rect best_node { 0, 0, 0, 0 };
+    int best_short_side_fit = std::numeric_limits<int>::max();
+    int best_long_side_fit = std::numeric_limits<int>::max();
+    const auto consider = [&](const Rect & __rect, int __width, int __height) {
+        const int leftover_horizontal = std::abs(__rect.width - __width);
+        const int leftover_vertical = std::abs(__rect.height - __height);
+        const int short_side_fit = std::min(leftover_horizontal, leftover_vertical);
+        const int long_side_fit = std::max(leftover_horizontal, leftover_vertical);
+        if(short_side_fit < best_short_side_fit ||
+            (short_side_fit == best_short_side_fit && long_side_fit < best_long_side_fit))
+        {
+            best_node = { __rect.x, __rect.y, __width, __height };
+            best_short_side_fit = short_side_fit;
+            best_long_side_fit = long_side_fit;
+        }
+    };
+    for(const FreeRect & free_rect : m_free_rects)
+    {
+        const Rect & rect = free_rect.rect;
+        if(rect.width >= _width && rect.height >= _height)
+            consider(rect, _width, _height);
+        if(m_allow_flip && rect.width >= _height && rect.height >= _width)
+            consider(rect, _height, _width);
+    }
+    return best_node;
+}
+
+IndexedMaxRectsAlgorithm::Rect IndexedMaxRectsAlgorithm::findPositionBestLongSideFit(int _width, int _height) const
+{
+    Rect best_node { 0, 0, 0, 0 };
+    int best_short_side_fit = std::numeric_limits<int>::max();
+    int best_long_side_fit = std::numeric_limits<int>::max();
+    const auto consider = [&](const Rect & __rect, int __width, int __height) {
+        const int leftover_horizontal = std::abs(__rect.width - __width);
+        const int leftover_vertical = std::abs(__rect.height - __height);
+        const int short_side_fit = std::min(leftover_horizontal, leftover_vertical);
+        const int long_side_fit = std::max(leftover_horizontal, leftover_vertical);
+        if(long_side_fit < best_long_side_fit ||
+            (long_side_fit == best_long_side_fit && short_side_fit < best_short_side_fit))
+        {
+            best_node = { __rect.x, __rect.y, __width, __height };
+            best_short_side_fit = short_side_fit;
+            best_long_side_fit = long_side_fit;
+        }
+    };
+    for(const FreeRect & free_rect : m_free_rects)
+    {
+        const Rect & rect = free_rect.rect;
+        if(rect.width >= _width && rect.height >= _height)
+            consider(rect, _width, _height);
+        if(m_allow_flip && rect.width >= _height && rect.height >= _width)
+            consider(rect, _height, _width);
+    }
+    return best_node;
+}
+
+IndexedMaxRectsAlgorithm::Rect IndexedMaxRectsAlgorithm::findPositionBestAreaFit(int _width, int _height) const
+{
+    Rect best_node { 0, 0, 0, 0 };
+    int best_area_fit = std::numeric_limits<int>::max();
+    int best_short_side_fit = std::numeric_limits<int>::max();
+    const auto consider = [&](const Rect & __rect, int __width, int __height) {
+        const int area_fit = __rect.width * __rect.height - __width * __height;
+        const int leftover_horizontal = std::abs(__rect.width - __width);
+        const int leftover_vertical = std::abs(__rect.height - __height);
+        const int short_side_fit = std::min(leftover_horizontal, leftover_vertical);
+        if(area_fit < best_area_fit || (area_fit == best_area_fit && short_side_fit < best_short_side_fit))
+        {
+            best_node = { __rect.x, __rect.y, __width, __height };
+            best_area_fit = area_fit;
+            best_short_side_fit = short_side_fit;
+        }
+    };
+    for(const FreeRect & free_rect : m_free_rects)
+    {
+        const Rect & rect = free_rect.rect;
+        if(rect.width >= _width && rect.height >= _height)
+            consider(rect, _width, _height);
+        if(m_allow_flip && rect.width >= _height && rect.height >= _width)
+            consider(rect, _height, _width);
+    }
+    return best_node;
+}
+
+IndexedMaxRectsAlgorithm::Rect IndexedMaxRectsAlgorithm::findPositionContactPoint(int _width, int _height)
+{
+    Rect best_node { 0, 0, 0, 0 };
+    int best_contact_score = -1;
+    for(const FreeRect & free_rect : m_free_rects)
+    {
+        const Rect & rect = free_rect.rect;
+        if(rect.width >= _width && rect.height >= _height)
+        {
+            const int score = contactPointScore({ rect.x, rect.y, _width, _height });
+            if(score > best_contact_score)
+            {
+                best_node = { rect.x, rect.y, _width, _height };
+                best_contact_score = score;
+            }
+        }
+        if(m_allow_flip && rect.width >= _height && rect.height >= _width)
+        {
+            const int score = contactPointScore({ rect.x, rect.y, _height, _width });
+            if(score > best_contact_score)
+            {
+                best_node = { rect.x, rect.y, _height, _width };
+                best_contact_score = score;
+            }
+        }
+    }
+    return best_node;
+}
+
+int IndexedMaxRectsAlgorithm::contactPointScore(const Rect & _rect)
+{
+    int score = 0;
+    if(_rect.x == 0 || _rect.x + _rect.width == m_bin_size.width())
+        score += _rect.height;
+    if(_rect.y == 0 || _rect.y + _rect.height == m_bin_size.height())
+        score += _rect.width;
+    // Only rectangles that touch the candidate have a non-zero common interval
+    const Rect neighbourhood { _rect.x - 1, _rect.y - 1, _rect.width + 2, _rect.height + 2 };
+    const quint32 stamp = nextStamp();
+    m_used_grid.forEachCell(neighbourhood, [&](std::vector<int> & __cell) {
+        for(int id : __cell)
+        {
+            if(m_used_stamps[id] == stamp)
+                continue;
+            m_used_stamps[id] = stamp;
+            const Rect & used = m_used_rects[id];
+            if(used.x == _rect.x + _rect.width || used.x + used.width == _rect.x)
+                score += commonIntervalLength(used.y, used.y + used.height, _rect.y, _rect.y + _rect.height);
+            if(used.y == _rect.y + _rect.height || used.y + used.height == _rect.y)
+                score += commonIntervalLength(used.x, used.x + used.width, _rect.x, _rect.x + _rect.width);
+        }
+    });
+    return score;
+}
+
+void IndexedMaxRectsAlgorithm::placeRect(const Rect & _node)
+{
+    // rbp walks the whole list and replaces each split rectangle with the last one, which is then
+    // tested at the same position. Only rectangles from the grid can be split, so walking their
+    // positions in ascending order reproduces the same sequence.
+    std::vector<int> positions;
+    const quint32 stamp = nextStamp();
+    m_free_grid.forEachCell(_node, [&](std::vector<int> & __cell) {
+        for(size_t i = 0; i < __cell.size();)
+        {
+            const int id = __cell[i];
+            if(m_positions[id] < 0)
+            {
+                __cell[i] = __cell.back();
+                __cell.pop_back();
+                continue;
+            }
+            ++i;
+            if(m_free_stamps[id] == stamp)
+                continue;
+            m_free_stamps[id] = stamp;
+            if(intersects(m_free_rects[m_positions[id]].rect, _node))
+                positions.push_back(m_positions[id]);
+        }
+    });
+    std::sort(positions.begin(), positions.end());
+
+    size_t begin = 0;
+    size_t end = positions.size();
+    while(begin < end)
+    {
+        const size_t position = static_cast<size_t>(positions[begin]);
+        splitFreeNode(m_free_rects[position].rect, _node);
+        const size_t last_position = m_free_rects.size() - 1;
+        const bool is_last_pending =
+            last_position != position &&
+            end - begin > 1 &&
+            static_cast<size_t>(positions[end - 1]) == last_position;
+        removeFreeRectangle(position);
+        if(is_last_pending)
+            --end; // The last rectangle has moved to the current position and is split next
+        else
+            ++begin;
+    }
+
+    pruneNewFreeRectangles();
+    for(const Rect & rect : m_new_free_rects)
+        addFreeRectangle(rect);
+    m_new_free_rects.clear();
+
+    if(m_heuristic == MaxRectsBinAtlasPackerChoiceHeuristic::ContactPointRule)
+    {
+        m_used_grid.add(static_cast<int>(m_used_rects.size()), _node);
+        m_used_stamps.push_back(0);
+    }
+    m_used_rects.push_back(_node);
+}
+
+void IndexedMaxRectsAlgorithm::splitFreeNode(const Rect & _free_node, const Rect & _used_node)
+{
+    // None of the up to four new rectangles can contain another one, so they are not tested against each other
+    m_new_free_rects_last_size = m_new_free_rects.size();
+
+    if(_used_node.x < _free_node.x + _free_node.width && _used_node.x + _used_node.width > _free_node.x)
+    {
+        if(_used_node.y > _free_node.y && _used_node.y < _free_node.y + _free_node.height)
+        {
+            Rect rect = _free_node;
+            rect.height = _used_node.y - rect.y;
+            insertNewFreeRectangle(rect);
+        }
+        if(_used_node.y + _used_node.height < _free_node.y + _free_node.height)
+        {
+            Rect rect = _free_node;
+            rect.y = _used_node.y + _used_node.height;
+            rect.height = _free_node.y + _free_node.height - (_used_node.y + _used_node.height);
+            insertNewFreeRectangle(rect);
+        }
+    }
+    if(_used_node.y < _free_node.y + _free_node.height && _used_node.y + _used_node.height > _free_node.y)
+    {
+        if(_used_node.x > _free_node.x && _used_node.x < _free_node.x + _free_node.width)
+        {
+            Rect rect = _free_node;
+            rect.width = _used_node.x - rect.x;
+            insertNewFreeRectangle(rect);
+        }
+        if(_used_node.x + _used_node.width < _free_node.x + _free_node.width)
+        {
+            Rect rect = _free_node;
+            rect.x = _used_node.x + _used_node.width;
+            rect.width = _free_node.x + _free_node.width - (_used_node.x + _used_node.width);
+            insertNewFreeRectangle(rect);
+        }
+    }
+}
+
+void IndexedMaxRectsAlgorithm::insertNewFreeRectangle(const Rect & _rect)
+{
+    for(size_t i = 0; i < m_new_free_rects_last_size;)
+    {
+        if(isContainedIn(_rect, m_new_free_rects[i]))
+            return;
+        if(isContainedIn(m_new_free_rects[i], _rect))
+        {
+            // Keeps the rectangles added by the current split at the end of the list
+            m_new_free_rects[i] = m_new_free_rects[--m_new_free_rects_last_size];
+            m_new_free_rects[m_new_free_rects_last_size] = m_new_free_rects.back();
+            m_new_free_rects.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    m_new_free_rects.push_back(_rect);
+}
+
+void IndexedMaxRectsAlgorithm::pruneNewFreeRectangles()
+{
+    // rbp tests every old rectangle against the remaining new ones and removes a contained new rectangle
+    // by replacing it with the last one. The first old rectangle that contains a new one decides when it
+    // is removed. A container overlaps the top left corner of the contained rectangle, so a single cell
+    // holds every candidate.
+    std::vector<int> first_containers(m_new_free_rects.size(), std::numeric_limits<int>::max());
+    std::vector<int> removal_steps;
+    for(size_t j = 0; j < m_new_free_rects.size(); ++j)
+    {
+        const Rect & rect = m_new_free_rects[j];
+        std::vector<int> & cell = m_free_grid.cellAt(rect.x, rect.y);
+        for(size_t i = 0; i < cell.size();)
+        {
+            const int position = m_positions[cell[i]];
+            if(position < 0)
+            {
+                cell[i] = cell.back();
+                cell.pop_back();
+                continue;
+            }
+            if(position < first_containers[j] && isContainedIn(rect, m_free_rects[position].rect))
+                first_containers[j] = position;
+            ++i;
+        }
+        if(first_containers[j] != std::numeric_limits<int>::max())
+            removal_steps.push_back(first_containers[j]);
+    }
+    std::sort(removal_steps.begin(), removal_steps.end());
+    removal_steps.erase(std::unique(removal_steps.begin(), removal_steps.end()), removal_steps.end());
+    for(int step : removal_steps)
+    {
+        for(size_t j = 0; j < m_new_free_rects.size();)
+        {
+            if(first_containers[j] == step)
+            {
+                m_new_free_rects[j] = m_new_free_rects.back();
+                m_new_free_rects.pop_back();
+                first_containers[j] = first_containers.back();
+                first_containers.pop_back();
+            }
+            else
+            {
+                ++j;
+            }
+        }
+    }
+}
+
+void IndexedMaxRectsAlgorithm::addFreeRectangle(const Rect & _rect)
+{
+    const int id = static_cast<int>(m_positions.size());
+    m_positions.push_back(static_cast<int>(m_free_rects.size()));
+    m_free_stamps.push_back(0);
+    m_free_rects.push_back({ _rect, id });
+    m_free_grid.add(id, _rect);
+}
+
+void IndexedMaxRectsAlgorithm::removeFreeRectangle(size_t _position)
+{
+    m_positions[m_free_rects[_position].id] = -1;
+    if(_position + 1 != m_free_rects.size())
+    {
+        m_free_rects[_position] = m_free_rects.back();
+        m_positions[m_free_rects[_position].id] = static_cast<int>(_position);
+    }
+    m_free_rects.pop_back();
+}
+
+quint32 IndexedMaxRectsAlgorithm::nextStamp()
+{
+    if(++m_stamp == 0)
+    {
+        std::fill(m_free_stamps.begin(), m_free_stamps.end(), 0);
+        std::fill(m_used_stamps.begin(), m_used_stamps.end(), 0);
+        m_stamp = 1;
+    }
+    return m_stamp;
+}
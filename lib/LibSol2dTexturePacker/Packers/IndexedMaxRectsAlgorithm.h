@@ -0,0 +1,98 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/MaxRectsBinAtlasPacker.h>
+#include <vector>
+
+// MaxRects with the heuristics, scores and tie-breaking of rbp::MaxRectsBinPack. Free rectangles are kept
+// in the same order as rbp keeps them, and a uniform grid finds the rectangles that a placement splits or
+// that contain a new free rectangle, so placement and pruning only touch the neighbourhood of the sprite.
+class S2TP_EXPORT IndexedMaxRectsAlgorithm final : public AtlasPackerOnlineAlgorithm
+{
+private:
+    struct Rect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct FreeRect
+    {
+        Rect rect;
+        int id;
+    };
+
+    struct Grid
+    {
+        int cell_size = 1;
+        int columns = 0;
+        int rows = 0;
+        std::vector<std::vector<int>> cells;
+
+        void reset(const QSize & _bin_size);
+        void add(int _id, const Rect & _rect);
+        std::vector<int> & cellAt(int _x, int _y);
+        template<typename Callback>
+        void forEachCell(const Rect & _rect, Callback _callback);
+    };
+
+public:
+    IndexedMaxRectsAlgorithm(
+        const QSize & _bin_size,
+        MaxRectsBinAtlasPackerChoiceHeuristic _heuristic,
+        bool _allow_flip);
+    QRect insert(int _width, int _height) override;
+    void resetBin() override;
+
+private:
+    Rect findPositionBottomLeft(int _width, int _height) const;
+    Rect findPositionBestShortSideFit(int _width, int _height) const;
+    Rect findPositionBestLongSideFit(int _width, int _height) const;
+    Rect findPositionBestAreaFit(int _width, int _height) const;
+    Rect findPositionContactPoint(int _width, int _height);
+    int contactPointScore(const Rect & _rect);
+    void placeRect(const Rect & _node);
+    void splitFreeNode(const Rect & _free_node, const Rect & _used_node);
+    void insertNewFreeRectangle(const Rect & _rect);
+    void pruneNewFreeRectangles();
+    void addFreeRectangle(const Rect & _rect);
+    void removeFreeRectangle(size_t _position);
+    quint32 nextStamp();
+
+private:
+    QSize m_bin_size;
+    MaxRectsBinAtlasPackerChoiceHeuristic m_heuristic;
+    bool m_allow_flip;
+    std::vector<FreeRect> m_free_rects;
+    // Position of each free rectangle in m_free_rects by its id, -1 when it was removed
+    std::vector<int> m_positions;
+    // Ids of free rectangles overlapping each cell, removed ids are dropped lazily
+    Grid m_free_grid;
+    std::vector<Rect> m_new_free_rects;
+    size_t m_new_free_rects_last_size;
+    // Used rectangles are indexed for the contact point rule only
+    std::vector<Rect> m_used_rects;
+    Grid m_used_grid;
+    std::vector<quint32> m_free_stamps;
+    std::vector<quint32> m_used_stamps;
+    quint32 m_stamp;
+};
@@ -17,14 +17,15 @@
  **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Packers/MaxRectsBinAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/IndexedMaxRectsAlgorithm.h>
 #include <RectangleBinPack/MaxRectsBinPack.h>
 
 namespace {
 
-class MaxRectsBinPackAlgorithm : public AtlasPackerOnlineAlgorithm
+class RbpMaxRectsBinPackAlgorithm : public AtlasPackerOnlineAlgorithm
 {
 public:
-    MaxRectsBinPackAlgorithm(
+    RbpMaxRectsBinPackAlgorithm(
         const QSize & _max_atlas_size,
         MaxRectsBinAtlasPackerChoiceHeuristic _heuristic,
         bool _allow_flip);
@@ -41,7 +42,7 @@ private:
     bool m_allow_flip;
 };
 
-MaxRectsBinPackAlgorithm::MaxRectsBinPackAlgorithm(
+RbpMaxRectsBinPackAlgorithm::RbpMaxRectsBinPackAlgorithm(
     const QSize & _max_atlas_size,
     MaxRectsBinAtlasPackerChoiceHeuristic _heuristic,
     bool _allow_flip
@@ -53,20 +54,20 @@ MaxRectsBinPackAlgorithm::MaxRectsBinPackAlgorithm(
 {
 }
 
-QRect MaxRectsBinPackAlgorithm::insert(int _width, int _height)
+QRect RbpMaxRectsBinPackAlgorithm::insert(int _width, int _height)
 {
     rbp::Rect rect = m_pack.Insert(_width, _height, m_heuristic);
     return QRect(rect.x, rect.y, rect.width, rect.height);
 }
 
-void MaxRectsBinPackAlgorithm::resetBin()
+void RbpMaxRectsBinPackAlgorithm::resetBin()
 {
     m_pack.Init(m_max_atlas_size.width(), m_max_atlas_size.height(), m_allow_flip);
 }
 
 } // namespace
 
-rbp::MaxRectsBinPack::FreeRectChoiceHeuristic MaxRectsBinPackAlgorithm::map(
+rbp::MaxRectsBinPack::FreeRectChoiceHeuristic RbpMaxRectsBinPackAlgorithm::map(
     MaxRectsBinAtlasPackerChoiceHeuristic _heuristic)
 {
     switch(_heuristic)
@@ -95,6 +96,8 @@ MaxRectsBinAtlasPacker::MaxRectsBinAtlasPacker(QObject * _parent) :
 
 std::unique_ptr<AtlasPackerOnlineAlgorithm> MaxRectsBinAtlasPacker::createAlgorithm(const QSize & _max_atlas_size) const
 {
+    if(m_engine == OnlineAlgorithmEngine::Native)
+        return std::make_unique<IndexedMaxRectsAlgorithm>(_max_atlas_size, m_heuristic, m_allow_flip);
     return std::unique_ptr<AtlasPackerOnlineAlgorithm>(
-        new MaxRectsBinPackAlgorithm(_max_atlas_size, m_heuristic, m_allow_flip));
+        new RbpMaxRectsBinPackAlgorithm(_max_atlas_size, m_heuristic, m_allow_flip));
 }
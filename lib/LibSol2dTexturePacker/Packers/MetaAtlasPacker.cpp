@@ -21,59 +21,122 @@
 #include <LibSol2dTexturePacker/Packers/SkylineBinAtlasPacker.h>
 #include <LibSol2dTexturePacker/Packers/GuillotineBinAtlaskPacker.h>
 #include <LibSol2dTexturePacker/Packers/ShelfBinAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/BranchAndBoundAtlasPacker.h>
+#include <optional>
 
 namespace {
 
-int calculateAtlasPackArea(const RawAtlasPack & _pack)
-{
-    int area = 0;
-    for(const RawAtlas & atlas : _pack)
-        area += atlas.image.width() * atlas.image.height();
-    return area;
-}
-
-bool operator < (const RawAtlasPack & _left, const RawAtlasPack & _rigth)
-{
-    return calculateAtlasPackArea(_left) < calculateAtlasPackArea(_rigth);
-}
+// The share of the progress range reserved for each trial
+constexpr int g_trial_progress_range = 1000;
+// Sets this small are searched exhaustively before the heuristics are tried
+constexpr qsizetype g_exact_search_sprite_limit = 40;
+constexpr qint64 g_exact_search_time_budget = 500;
 
 } // namespace
 
 MetaAtlasPacker::MetaAtlasPacker(QObject * _parent) :
-    AtlasPacker(_parent)
+    AtlasPacker(_parent),
+    m_cost_model(AtlasPackCostModel::create(AtlasPackCostModelType::TotalArea)),
+    m_time_budget(0),
+    m_tolerance(0.0)
 {
 }
 
 std::unique_ptr<RawAtlasPack> MetaAtlasPacker::pack(
-    QPromise<void> & _promise,
+    AtlasPackerContext & _context,
     const QList<Sprite> & _sprites,
     const AtlasPackerOptions & _options) const
 {
-    if(isCanceled(_promise)) return nullptr;
-    std::unique_ptr<RawAtlasPack> result = packBestMaxRectsBinAtlasPacker(_promise, _sprites, _options);
-
-    if(isCanceled(_promise)) return nullptr;
-    std::unique_ptr<RawAtlasPack> temp = packBestSkylineBinAtlasPacker(_promise, _sprites, _options);
-    if(*temp < *result) result.reset(temp.release());
-
-    if(isCanceled(_promise)) return nullptr;
-    temp = packBestGuillotineBinAtlaskPacker(_promise, _sprites, _options);
-    if(*temp < *result) result.reset(temp.release());
-
-    if(isCanceled(_promise)) return nullptr;
-    temp = packBestShelfBinAtlasPacker(_promise, _sprites, _options);
-    if(*temp < *result) result.reset(temp.release());
+    Candidates candidates;
+    if(_sprites.count() <= g_exact_search_sprite_limit)
+        addBranchAndBoundAtlasPackers(candidates);
+    addMaxRectsBinAtlasPackers(candidates);
+    addSkylineBinAtlasPackers(candidates);
+    addGuillotineBinAtlaskPackers(candidates);
+    addShelfBinAtlasPackers(candidates);
 
+    const std::shared_ptr<const AtlasPackCostModel> cost_model = m_cost_model;
+    const QDeadlineTimer deadline = m_time_budget > 0
+        ? QDeadlineTimer(m_time_budget)
+        : QDeadlineTimer(QDeadlineTimer::Forever);
+    const int candidate_count = static_cast<int>(candidates.size());
+    _context.setProgressMaximum(candidate_count * g_trial_progress_range);
+    PackStatistics statistics;
+    std::unique_ptr<RawAtlasPack> result;
+    AtlasPackCost result_cost;
+    // The cost no layout can go below, known after the first trial has prepared the sprites
+    std::optional<AtlasPackCost> global_bound;
+    // Counters describe the winning layout, timings cover every configuration that was tried
+    const auto applyStatistics = [&statistics](RawAtlasPack & __pack) {
+        __pack.statistics().phases = statistics.phases;
+        __pack.statistics().trial_count = statistics.trial_count;
+        __pack.statistics().pruned_trial_count = statistics.pruned_trial_count;
+    };
+    for(int i = 0; i < candidate_count; ++i)
+    {
+        if(_context.isCanceled())
+            return nullptr;
+        if(result && deadline.hasExpired())
+            break;
+        if(result && global_bound && isWithinTolerance(result_cost, *global_bound, m_tolerance))
+            break;
+        AtlasPackerContext trial_context(_context, i * g_trial_progress_range, (i + 1) * g_trial_progress_range);
+        // The first trial always runs to the end, so there is a result to return
+        if(result)
+            trial_context.setDeadline(deadline);
+        trial_context.setBoundCallback([&](const AtlasPackBound & __bound) {
+            const AtlasPackCost bound = cost_model->lowerBound(__bound);
+            if(!global_bound && __bound.closed_atlas_sizes.isEmpty())
+                global_bound = bound;
+            return result && !(bound < result_cost);
+        });
+        ++statistics.trial_count;
+        std::unique_ptr<RawAtlasPack> pack = candidates[i]->pack(trial_context, _sprites, _options);
+        if(!pack)
+        {
+            if(_context.isCanceled())
+                return nullptr;
+            if(deadline.hasExpired())
+                break;
+            ++statistics.pruned_trial_count;
+            _context.setProgressValue((i + 1) * g_trial_progress_range);
+            continue;
+        }
+        statistics.addPhases(pack->statistics());
+        const AtlasPackCost cost = cost_model->cost(*pack);
+        if(!result || cost < result_cost)
+        {
+            result.reset(pack.release());
+            result_cost = cost;
+            if(_context.hasResultCallback())
+            {
+                std::unique_ptr<RawAtlasPack> intermediate = result->clone();
+                applyStatistics(*intermediate);
+                _context.publishResult(*intermediate);
+            }
+        }
+        _context.setProgressValue((i + 1) * g_trial_progress_range);
+    }
+    if(!result)
+        return nullptr;
+    _context.setProgressValue(candidate_count * g_trial_progress_range);
+    applyStatistics(*result);
     return result;
 }
 
-std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestMaxRectsBinAtlasPacker(
-    QPromise<void> & _promise,
-    const QList<Sprite> & _sprites,
-    const AtlasPackerOptions & _options) const
+void MetaAtlasPacker::addBranchAndBoundAtlasPackers(Candidates & _candidates)
+{
+    for(bool allow_flip : { false, true })
+    {
+        std::unique_ptr<BranchAndBoundAtlasPacker> packer = std::make_unique<BranchAndBoundAtlasPacker>();
+        packer->allowFlip(allow_flip);
+        packer->setTimeBudget(g_exact_search_time_budget);
+        _candidates.push_back(std::move(packer));
+    }
+}
+
+void MetaAtlasPacker::addMaxRectsBinAtlasPackers(Candidates & _candidates)
 {
-    std::unique_ptr<RawAtlasPack> result;
-    MaxRectsBinAtlasPacker packer;
     for(auto heuristic : {
         MaxRectsBinAtlasPackerChoiceHeuristic::BestLongSideFit,
         MaxRectsBinAtlasPackerChoiceHeuristic::BestShortSideFit,
@@ -84,25 +147,16 @@ std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestMaxRectsBinAtlasPacker(
     {
         for(bool allow_flip : { false, true })
         {
-            if(isCanceled(_promise))
-                return nullptr;
-            packer.allowFlip(allow_flip);
-            packer.setChoiceHeuristic(heuristic);
-            std::unique_ptr<RawAtlasPack> pack = packer.pack(_promise, _sprites, _options);
-            if(!result || *pack < *result)
-                result.reset(pack.release());
+            std::unique_ptr<MaxRectsBinAtlasPacker> packer = std::make_unique<MaxRectsBinAtlasPacker>();
+            packer->allowFlip(allow_flip);
+            packer->setChoiceHeuristic(heuristic);
+            _candidates.push_back(std::move(packer));
         }
     }
-    return result;
 }
 
-std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestSkylineBinAtlasPacker(
-    QPromise<void> & _promise,
-    const QList<Sprite> & _sprites,
-    const AtlasPackerOptions & _options) const
+void MetaAtlasPacker::addSkylineBinAtlasPackers(Candidates & _candidates)
 {
-    std::unique_ptr<RawAtlasPack> result;
-    SkylineBinAtlasPacker packer;
     for(auto heuristic : {
         SkylineBinAtlasPackerLevelChoiceHeuristic::BottomLeft,
         SkylineBinAtlasPackerLevelChoiceHeuristic::MinWasteFit
@@ -110,25 +164,16 @@ std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestSkylineBinAtlasPacker(
     {
         for(bool use_waste_map : { false, true })
         {
-            if(isCanceled(_promise))
-                return nullptr;
-            packer.enableWasteMap(use_waste_map);
-            packer.setLevelChoiceHeuristic(heuristic);
-            std::unique_ptr<RawAtlasPack> pack = packer.pack(_promise, _sprites, _options);
-            if(!result || *pack < *result)
-                result.reset(pack.release());
+            std::unique_ptr<SkylineBinAtlasPacker> packer = std::make_unique<SkylineBinAtlasPacker>();
+            packer->enableWasteMap(use_waste_map);
+            packer->setLevelChoiceHeuristic(heuristic);
+            _candidates.push_back(std::move(packer));
         }
     }
-    return result;
 }
 
-std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestGuillotineBinAtlaskPacker(
-    QPromise<void> & _promise,
-    const QList<Sprite> & _sprites,
-    const AtlasPackerOptions & _options) const
+void MetaAtlasPacker::addGuillotineBinAtlaskPackers(Candidates & _candidates)
 {
-    std::unique_ptr<RawAtlasPack> result;
-    GuillotineBinAtlaskPacker packer;
     for(auto choice_heuristic : {
         GuillotineBinAtlasPackerChoiceHeuristic::BestAreaFit,
         GuillotineBinAtlasPackerChoiceHeuristic::BestShortSideFit,
@@ -149,27 +194,18 @@ std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestGuillotineBinAtlaskPacker
         {
             for(bool enable_merge : { false, true })
             {
-                if(isCanceled(_promise))
-                    return nullptr;
-                packer.enableMerge(enable_merge);
-                packer.setChoiceHeuristic(choice_heuristic);
-                packer.setSplitHeuristic(split_heuristic);
-                std::unique_ptr<RawAtlasPack> pack = packer.pack(_promise, _sprites, _options);
-                if(!result || *pack < *result)
-                    result.reset(pack.release());
+                std::unique_ptr<GuillotineBinAtlaskPacker> packer = std::make_unique<GuillotineBinAtlaskPacker>();
+                packer->enableMerge(enable_merge);
+                packer->setChoiceHeuristic(choice_heuristic);
+                packer->setSplitHeuristic(split_heuristic);
+                _candidates.push_back(std::move(packer));
             }
         }
     }
-    return result;
 }
 
-std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestShelfBinAtlasPacker(
-    QPromise<void> & _promise,
-    const QList<Sprite> & _sprites,
-    const AtlasPackerOptions & _options) const
+void MetaAtlasPacker::addShelfBinAtlasPackers(Candidates & _candidates)
 {
-    std::unique_ptr<RawAtlasPack> result;
-    ShelfBinAtlasPacker packer;
     for(auto heuristic : {
         ShelfBinAtlasPackerChoiceHeuristic::NextFit,
         ShelfBinAtlasPackerChoiceHeuristic::FirstFit,
@@ -182,14 +218,10 @@ std::unique_ptr<RawAtlasPack> MetaAtlasPacker::packBestShelfBinAtlasPacker(
     {
         for(bool use_waste_map : { false, true })
         {
-            if(isCanceled(_promise))
-                return nullptr;
-            packer.enableWasteMap(use_waste_map);
-            packer.setChoiceHeuristic(heuristic);
-            std::unique_ptr<RawAtlasPack> pack = packer.pack(_promise, _sprites, _options);
-            if(!result || *pack < *result)
-                result.reset(pack.release());
+            std::unique_ptr<ShelfBinAtlasPacker> packer = std::make_unique<ShelfBinAtlasPacker>();
+            packer->enableWasteMap(use_waste_map);
+            packer->setChoiceHeuristic(heuristic);
+            _candidates.push_back(std::move(packer));
         }
     }
-    return result;
 }
@@ -19,32 +19,39 @@
 #pragma once
 
 #include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/AtlasPackCostModel.h>
+#include <vector>
 
 class S2TP_EXPORT MetaAtlasPacker final : public AtlasPacker
 {
 public:
     explicit MetaAtlasPacker(QObject * _parent = nullptr);
+    void setCostModel(std::shared_ptr<const AtlasPackCostModel> _model) { m_cost_model = std::move(_model); }
+    std::shared_ptr<const AtlasPackCostModel> costModel() const { return m_cost_model; }
+    // When the budget in milliseconds runs out, the best result found so far is returned. Zero means no limit.
+    void setTimeBudget(qint64 _milliseconds) { m_time_budget = _milliseconds; }
+    qint64 timeBudget() const { return m_time_budget; }
+    // The search stops once the best cost is within this fraction of the lower bound of all layouts
+    void setTolerance(double _tolerance) { m_tolerance = _tolerance; }
+    double tolerance() const { return m_tolerance; }
 
     std::unique_ptr<RawAtlasPack> pack(
-        QPromise<void> & _promise,
+        AtlasPackerContext & _context,
         const QList<Sprite> & _sprites,
         const AtlasPackerOptions & _options) const override;
 
 private:
-    std::unique_ptr<RawAtlasPack> packBestMaxRectsBinAtlasPacker(
-        QPromise<void> & _promise,
-        const QList<Sprite> & _sprites,
-        const AtlasPackerOptions & _options) const;
-    std::unique_ptr<RawAtlasPack> packBestSkylineBinAtlasPacker(
-        QPromise<void> & _promise,
-        const QList<Sprite> & _sprites,
-        const AtlasPackerOptions & _options) const;
-    std::unique_ptr<RawAtlasPack> packBestGuillotineBinAtlaskPacker(
-        QPromise<void> & _promise,
-        const QList<Sprite> & _sprites,
-        const AtlasPackerOptions & _options) const;
-    std::unique_ptr<RawAtlasPack> packBestShelfBinAtlasPacker(
-        QPromise<void> & _promise,
-        const QList<Sprite> & _sprites,
-        const AtlasPackerOptions & _options) const;
+    typedef std::vector<std::unique_ptr<AtlasPacker>> Candidates;
+
+private:
+    static void addBranchAndBoundAtlasPackers(Candidates & _candidates);
+    static void addMaxRectsBinAtlasPackers(Candidates & _candidates);
+    static void addSkylineBinAtlasPackers(Candidates & _candidates);
+    static void addGuillotineBinAtlaskPackers(Candidates & _candidates);
+    static void addShelfBinAtlasPackers(Candidates & _candidates);
+
+private:
+    std::shared_ptr<const AtlasPackCostModel> m_cost_model;
+    qint64 m_time_budget;
+    double m_tolerance;
 };
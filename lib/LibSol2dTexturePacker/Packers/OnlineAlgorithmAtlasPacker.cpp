@@ -17,245 +17,653 @@
  **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Packers/OnlineAlgorithmAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Packers/AtlasPackCostModel.h>
 #include <LibSol2dTexturePacker/Exception.h>
-#include <QCryptographicHash>
 #include <QFileInfo>
-#include <QPainter>
+#include <QHash>
 #include <QRect>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
 
 namespace {
 
-struct Item
-{
-    Item(
-        const QImage * _image,
-        const QString & _name,
-        const QRect & _source_rect,
-        const QRect & _destination_rect,
-        bool _is_rotated
-    ) :
-        image(_image),
-        name(_name),
-        sprite_rect(_source_rect),
-        texture_rect(_destination_rect),
-        is_rotated(_is_rotated)
-    {
-    }
+typedef QList<PlacedSprite> Bin;
+
+// Sets with more distinct sprite sizes are left to the algorithm
+constexpr qsizetype g_grid_layout_size_limit = 4;
+// Partitions smaller than this are not worth a thread
+constexpr qsizetype g_min_partition_sprite_count = 1024;
 
-    const QImage * image;
-    QString name;
-    QRect sprite_rect;
-    QRect texture_rect;
-    QByteArray hash_sum;
-    bool is_rotated;
+enum ProgressPass
+{
+    CropPass,
+    HashPass,
+    PlacementPass,
+    RenderPass,
+    ProgressPassCount
 };
 
-QImage render(const std::list<Item> & _items)
+QList<Frame> binToFrames(const Bin & _bin)
+{
+    QList<Frame> frames;
+    frames.reserve(_bin.size());
+    for(const PlacedSprite & sprite : _bin)
+        frames.append(sprite.frame);
+    return frames;
+}
+
+QSize calculateBinSize(const Bin & _bin)
 {
     int max_x = 0;
     int max_y = 0;
-    foreach(const Item & item, _items)
+    for(const PlacedSprite & sprite : _bin)
     {
-        int x = item.texture_rect.x() + item.texture_rect.width();
-        int y = item.texture_rect.y() + item.texture_rect.height();
-        if(x > max_x) max_x = x;
-        if(y > max_y) max_y = y;
+        max_x = std::max(max_x, sprite.frame.texture_rect.x() + sprite.frame.texture_rect.width());
+        max_y = std::max(max_y, sprite.frame.texture_rect.y() + sprite.frame.texture_rect.height());
     }
-    QImage image(max_x, max_y, QImage::Format_RGBA8888);
-    image.fill(Qt::transparent);
-    QPainter painter(&image);
-
-    QTransform rotation;
-    rotation.rotate(90);
+    return QSize(max_x, max_y);
+}
 
-    for(const Item & item : _items)
+double calculateOccupancy(const Bin & _bin, const QImage & _image)
+{
+    qint64 used_area = 0;
+    for(const PlacedSprite & sprite : _bin)
     {
-        if(item.image == nullptr)
-            continue;
-        painter.drawImage(
-            item.texture_rect,
-            item.is_rotated ? item.image->transformed(rotation) : *item.image,
-            item.is_rotated
-                ? QRect(
-                      item.sprite_rect.height() - item.texture_rect.width() - item.sprite_rect.y(),
-                      item.sprite_rect.x(),
-                      item.texture_rect.width(),
-                      item.texture_rect.height())
-                : QRect(
-                      item.sprite_rect.x(),
-                      item.sprite_rect.y(),
-                      item.texture_rect.width(),
-                      item.texture_rect.height())
-        );
+        if(sprite.image != nullptr)
+            used_area += static_cast<qint64>(sprite.frame.texture_rect.width()) * sprite.frame.texture_rect.height();
     }
-    return image;
+    const qint64 area = static_cast<qint64>(_image.width()) * _image.height();
+    return area == 0 ? 0.0 : static_cast<double>(used_area) / static_cast<double>(area);
 }
 
-QRect crop(const QImage & _image)
+// GridPack cuts whole cells as they are, so the sprites must neither lose their transparent borders nor be turned
+bool isUntrimmed(const Bin & _bin)
 {
-    int top = 0, bottom = 0, left = 0, right = 0;
+    return std::all_of(_bin.cbegin(), _bin.cend(), [](const PlacedSprite & __sprite) {
+        const Frame & frame = __sprite.frame;
+        return frame.sprite_rect == QRect(QPoint(0, 0), frame.texture_rect.size()) &&
+            !frame.is_rotated && !frame.is_flipped_horizontally && !frame.is_flipped_vertically;
+    });
+}
+
+QString makeSpriteName(const Sprite & _sprite, const AtlasPackerOptions & _options)
+{
+    return _options.remove_file_extensions
+        ? QFileInfo(_sprite.name).baseName()
+        : QFileInfo(_sprite.name).fileName();
+}
+
+struct GridGroup
+{
+    QSize size;
+    QList<qsizetype> sprites;
+    qsizetype placed_count;
+};
 
-    for(int y = 0; y < _image.height(); ++y)
+struct GridLayout
+{
+    // The bin and the position of every sprite, duplicates share them with their originals
+    QList<qsizetype> bins;
+    QList<QPoint> positions;
+    QList<QSize> bin_sizes;
+    QList<std::optional<GridOptions>> grids;
+};
+
+// The width at which the remaining sprites take the least area in one bin, or the bin width when they do not fit
+int chooseGridWidth(const std::vector<GridGroup> & _groups, const QSize & _max_atlas_size)
+{
+    int best_width = _max_atlas_size.width();
+    qint64 best_area = std::numeric_limits<qint64>::max();
+    qint64 best_side = std::numeric_limits<qint64>::max();
+    for(const GridGroup & candidate : _groups)
     {
-        bool exit = false;
-        for(int x = 0; x < _image.width(); ++x)
+        if(candidate.placed_count == candidate.sprites.count())
+            continue;
+        for(int width = candidate.size.width(); width <= _max_atlas_size.width(); width += candidate.size.width())
         {
-            if(qAlpha(_image.pixel(x, y)) != 0)
+            qint64 height = 0;
+            int used_width = 0;
+            for(const GridGroup & group : _groups)
             {
-                exit = true;
-                break;
+                const qsizetype remaining_count = group.sprites.count() - group.placed_count;
+                if(remaining_count == 0)
+                    continue;
+                const qsizetype column_count = width / group.size.width();
+                if(column_count == 0)
+                {
+                    height = std::numeric_limits<qint64>::max();
+                    break;
+                }
+                height += (remaining_count + column_count - 1) / column_count * group.size.height();
+                used_width = std::max(used_width, static_cast<int>(std::min(remaining_count, column_count)) * group.size.width());
+            }
+            if(height > _max_atlas_size.height())
+                continue;
+            // Of the layouts with the same area, the squarest one
+            const qint64 area = static_cast<qint64>(used_width) * height;
+            const qint64 side = std::max<qint64>(used_width, height);
+            if(area < best_area || (area == best_area && side < best_side))
+            {
+                best_area = area;
+                best_side = side;
+                best_width = width;
             }
         }
-        if(exit) break;
-        ++top;
     }
+    return best_width;
+}
 
-    for(int y = _image.height() - 1; y >= 0; --y)
+// Sprites of each size fill rows of their own, the tallest sprites go first.
+// Returns nothing when the sprites have too many distinct sizes or one of them does not fit into a bin.
+std::optional<GridLayout> planGridLayout(
+    const QList<QRect> & _sprite_rects,
+    const QList<qsizetype> & _originals,
+    const QSize & _max_atlas_size)
+{
+    std::vector<GridGroup> groups;
+    for(qsizetype i = 0; i < _sprite_rects.count(); ++i)
     {
-        bool exit = false;
-        for(int x = 0; x < _image.width(); ++x)
+        if(_originals[i] != i)
+            continue;
+        const QSize size = _sprite_rects[i].size();
+        if(size.isEmpty() || size.width() > _max_atlas_size.width() || size.height() > _max_atlas_size.height())
+            return std::nullopt;
+        auto group = std::find_if(groups.begin(), groups.end(), [&size](const GridGroup & __group) {
+            return __group.size == size;
+        });
+        if(group == groups.end())
         {
-            if(qAlpha(_image.pixel(x, y)) != 0)
-            {
-                exit = true;
-                break;
-            }
+            if(static_cast<qsizetype>(groups.size()) == g_grid_layout_size_limit)
+                return std::nullopt;
+            groups.push_back({ .size = size, .sprites = {}, .placed_count = 0 });
+            group = std::prev(groups.end());
         }
-        if(exit) break;
-        ++bottom;
+        group->sprites.append(i);
     }
+    std::stable_sort(groups.begin(), groups.end(), [](const GridGroup & __a, const GridGroup & __b) {
+        return __a.size.height() > __b.size.height();
+    });
 
-    for(int x = 0; x < _image.width(); ++x)
+    GridLayout layout;
+    layout.bins.resize(_sprite_rects.count());
+    layout.positions.resize(_sprite_rects.count());
+    for(;;)
     {
-        bool exit = false;
-        for(int y = _image.height() - bottom - 1; y > top; --y)
+        const bool is_placed = std::all_of(groups.cbegin(), groups.cend(), [](const GridGroup & __group) {
+            return __group.placed_count == __group.sprites.count();
+        });
+        if(is_placed)
+            break;
+        const int width = chooseGridWidth(groups, _max_atlas_size);
+        const qsizetype bin = layout.bin_sizes.count();
+        int y = 0;
+        int used_width = 0;
+        int row_count = 0;
+        int used_group_count = 0;
+        const GridGroup * last_group = nullptr;
+        for(GridGroup & group : groups)
         {
-            if(qAlpha(_image.pixel(x, y)) != 0)
+            const int column_count = width / group.size.width();
+            if(column_count == 0 || group.placed_count == group.sprites.count())
+                continue;
+            if(y + group.size.height() > _max_atlas_size.height())
+                continue;
+            ++used_group_count;
+            last_group = &group;
+            while(group.placed_count < group.sprites.count() && y + group.size.height() <= _max_atlas_size.height())
             {
-                exit = true;
-                break;
+                const int count = static_cast<int>(std::min<qsizetype>(column_count, group.sprites.count() - group.placed_count));
+                for(int column = 0; column < count; ++column)
+                {
+                    const qsizetype sprite = group.sprites[group.placed_count++];
+                    layout.bins[sprite] = bin;
+                    layout.positions[sprite] = QPoint(column * group.size.width(), y);
+                }
+                used_width = std::max(used_width, count * group.size.width());
+                y += group.size.height();
+                ++row_count;
             }
         }
-        if(exit) break;
-        ++left;
+        layout.bin_sizes.append(QSize(used_width, y));
+        if(used_group_count == 1)
+        {
+            layout.grids.append(GridOptions {
+                .column_count = used_width / last_group->size.width(),
+                .row_count = row_count,
+                .sprite_width = last_group->size.width(),
+                .sprite_height = last_group->size.height(),
+                .margin_top = 0,
+                .margin_left = 0,
+                .horizontal_spacing = 0,
+                .vertical_spacing = 0
+            });
+        }
+        else
+        {
+            layout.grids.append(std::nullopt);
+        }
     }
+    for(qsizetype i = 0; i < _sprite_rects.count(); ++i)
+    {
+        if(_originals[i] != i)
+        {
+            layout.bins[i] = layout.bins[_originals[i]];
+            layout.positions[i] = layout.positions[_originals[i]];
+        }
+    }
+    return layout;
+}
+
+struct PlacementInput
+{
+    const QList<Sprite> & sprites;
+    // The images placed sprites are rendered from
+    const QList<QImage> & images;
+    const QList<QRect> & sprite_rects;
+    // The index of the first sprite with the same content, or the sprite's own index
+    const QList<qsizetype> & originals;
+    // How each duplicate is turned relative to its original
+    const QList<SpriteOrientation> & orientations;
+    const SpritePlacementOrder & order;
+    const AtlasPackerOptions & options;
+};
 
-    for(int x = _image.width() - 1; x >= 0; --x)
+enum class PlacementStatus
+{
+    Placed,
+    Stopped,
+    OversizedSprite
+};
+
+// Places the sprites at the given positions of the order, a new bin is opened when the last one is full.
+// Both callbacks get the position of the sprite and stop the placement by returning false. The first one
+// is called before each sprite, the second one before a new bin is opened.
+PlacementStatus placeSprites(
+    AtlasPackerOnlineAlgorithm & _algorithm,
+    const PlacementInput & _input,
+    const QList<qsizetype> & _positions,
+    QList<Bin> & _bins,
+    const std::function<bool(qsizetype)> & _before_sprite,
+    const std::function<bool(qsizetype)> & _before_bin)
+{
+    if(_bins.isEmpty())
+        _bins.emplace_back();
+    // Maps the original sprite index to its position in the current bin
+    QHash<qsizetype, qsizetype> bin_originals;
+    for(qsizetype k : _positions)
     {
-        bool exit = false;
-        for(int y = _image.height() - bottom - 1; y > top; --y)
+        if(!_before_sprite(k))
+            return PlacementStatus::Stopped;
+        const qsizetype i = _input.order.indices[k];
+        const Sprite & sprite = _input.sprites[i];
+        const QString sprite_name = makeSpriteName(sprite, _input.options);
+        const QRect & sprite_rect = _input.sprite_rects[i];
+        const QRect source_rect(sprite_rect.topLeft(), _input.images[i].size());
+        auto duplicate = bin_originals.constFind(_input.originals[i]);
+        if(duplicate != bin_originals.cend())
         {
-            if(qAlpha(_image.pixel(x, y)) != 0)
+            // The texture is shared, the trim offset, the source size and the orientation are its own
+            Bin & bin = _bins.last();
+            PlacedSprite placed_sprite = bin[duplicate.value()];
+            placed_sprite.image = nullptr;
+            placed_sprite.frame.sprite_rect = source_rect;
+            orientFrame(placed_sprite.frame, _input.orientations[i]);
+            placed_sprite.frame.name = sprite_name;
+            bin.append(placed_sprite);
+            continue;
+        }
+        // The cell is rounded up to whole blocks, so that no other sprite shares a compression block with this one
+        const QSize cell_size = alignSpriteSize(sprite_rect.size(), _input.options.block_size);
+    RETRY:
+        const QRect cell = _input.order.rotations[k]
+            ? _algorithm.insert(cell_size.height(), cell_size.width())
+            : _algorithm.insert(cell_size.width(), cell_size.height());
+        if(cell.isNull())
+        {
+            if(_bins.last().empty())
+                return PlacementStatus::OversizedSprite;
+            if(!_before_bin(k))
+                return PlacementStatus::Stopped;
+            _bins.emplace_back();
+            bin_originals.clear();
+            _algorithm.resetBin();
+            goto RETRY;
+        }
+        const bool is_rotated = cell.width() != cell_size.width();
+        bin_originals.insert(_input.originals[i], _bins.last().count());
+        _bins.last().append({
+            .image = &_input.images[i],
+            .frame =
             {
-                exit = true;
-                break;
+                .texture_rect = QRect(cell.topLeft(), is_rotated ? sprite_rect.size().transposed() : sprite_rect.size()),
+                .sprite_rect = source_rect,
+                .name = sprite_name,
+                .is_rotated = is_rotated,
+                .is_flipped_horizontally = false,
+                .is_flipped_vertically = false
             }
-        }
-        if(exit) break;
-        ++right;
+        });
     }
-
-    return QRect(left, top, _image.width() - left - right, _image.height() - top - bottom);
+    return PlacementStatus::Placed;
 }
 
-QList<Frame> itemsToFrames(std::list<Item> _items)
+struct Partition
 {
-    QList<Frame> frames;
-    frames.reserve(_items.size());
-    for(const Item & item : _items)
+    // Positions in the placement order, ascending
+    QList<qsizetype> positions;
+    std::unique_ptr<AtlasPackerOnlineAlgorithm> algorithm;
+    QList<Bin> bins;
+    // The index in the positions of the first sprite of the last bin
+    qsizetype last_bin_start = 0;
+    PlacementStatus status = PlacementStatus::Placed;
+};
+
+// Unique sprites are dealt out largest first to the partition with the least area,
+// duplicates follow their originals
+std::vector<Partition> partitionSprites(const PlacementInput & _input, int _partition_count)
+{
+    const qsizetype sprite_count = _input.order.indices.count();
+    const auto area = [&_input](qsizetype __position) {
+        const QRect & rect = _input.sprite_rects[_input.order.indices[__position]];
+        return static_cast<qint64>(rect.width()) * rect.height();
+    };
+    QList<qsizetype> unique_positions;
+    for(qsizetype k = 0; k < sprite_count; ++k)
     {
-        frames.append({
-            .texture_rect = item.texture_rect,
-            .sprite_rect = item.sprite_rect,
-            .name = item.name,
-            .is_rotated = item.is_rotated
-        });
+        const qsizetype i = _input.order.indices[k];
+        if(_input.originals[i] == i)
+            unique_positions.append(k);
     }
-    return frames;
+    std::stable_sort(unique_positions.begin(), unique_positions.end(), [&area](qsizetype __a, qsizetype __b) {
+        return area(__a) > area(__b);
+    });
+    std::vector<Partition> partitions(_partition_count);
+    std::vector<qint64> partition_areas(_partition_count, 0);
+    QList<int> sprite_partitions(sprite_count, 0);
+    for(qsizetype k : unique_positions)
+    {
+        const int partition = static_cast<int>(
+            std::min_element(partition_areas.cbegin(), partition_areas.cend()) - partition_areas.cbegin());
+        partitions[partition].positions.append(k);
+        partition_areas[partition] += area(k);
+        sprite_partitions[_input.order.indices[k]] = partition;
+    }
+    for(qsizetype k = 0; k < sprite_count; ++k)
+    {
+        const qsizetype i = _input.order.indices[k];
+        if(_input.originals[i] != i)
+            partitions[sprite_partitions[_input.originals[i]]].positions.append(k);
+    }
+    for(Partition & partition : partitions)
+        std::sort(partition.positions.begin(), partition.positions.end());
+    return partitions;
 }
 
-const Item * findDuplicate(const std::list<Item> & _items, const QByteArray & _hash_sum)
+// Checks the bound once all sprites have been placed, the last bin is the open one
+bool exceedsBound(AtlasPackerContext & _context, const QList<Bin> & _bins, const AtlasPackerOptions & _options)
 {
-    for(const Item & item : _items)
+    if(!_context.hasBoundCallback() || _bins.isEmpty())
+        return false;
+    AtlasPackBound bound { .max_atlas_size = _options.max_atlas_size };
+    for(qsizetype i = 0; i < _bins.count() - 1; ++i)
+        bound.closed_atlas_sizes.append(calculateBinSize(_bins[i]));
+    for(const PlacedSprite & sprite : _bins.last())
     {
-        if(item.hash_sum.compare(_hash_sum) == 0)
-            return &item;
+        if(sprite.image != nullptr)
+            bound.remaining_sprite_area += static_cast<qint64>(sprite.frame.texture_rect.width()) * sprite.frame.texture_rect.height();
     }
-    return nullptr;
+    return _context.isBoundExceeded(bound);
 }
 
 } // namespace name
 
 std::unique_ptr<RawAtlasPack> OnlineAlgorithmAtlasPacker::pack(
-    QPromise<void> & _promise,
+    AtlasPackerContext & _context,
     const QList<Sprite> & _sprites,
     const AtlasPackerOptions & _options) const
 {
-    std::list<Item> items;
+    SpritePlacementOrder order;
+    order.indices.resize(_sprites.count());
+    order.rotations.fill(false, _sprites.count());
+    for(qsizetype i = 0; i < _sprites.count(); ++i)
+        order.indices[i] = i;
+    return pack(_context, _sprites, _options, order, m_is_grid_layout_enabled);
+}
+
+std::unique_ptr<RawAtlasPack> OnlineAlgorithmAtlasPacker::pack(
+    AtlasPackerContext & _context,
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options,
+    const SpritePlacementOrder & _order) const
+{
+    return pack(_context, _sprites, _options, _order, false);
+}
+
+std::unique_ptr<RawAtlasPack> OnlineAlgorithmAtlasPacker::pack(
+    AtlasPackerContext & _context,
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options,
+    const SpritePlacementOrder & _order,
+    bool _allow_grid_layout) const
+{
+    if(_order.indices.count() != _sprites.count() || _order.rotations.count() != _sprites.count())
+        throw InvalidOperationExeption(tr("The placement order does not match the sprites"));
+
     std::unique_ptr<RawAtlasPack> result = std::make_unique<RawAtlasPack>();
-    std::unique_ptr<AtlasPackerOnlineAlgorithm> algorithm = createAlgorithm(_options.max_atlas_size);
-    foreach(const Sprite & sprite, _sprites)
+    PackStatistics & statistics = result->statistics();
+    statistics.sprite_count = _sprites.count();
+
+    // Cropping, hashing, placement and rendering advance the progress by one step per sprite each
+    const int sprite_count = static_cast<int>(_sprites.count());
+    _context.setProgressMaximum(ProgressPassCount * sprite_count);
+
+    SpriteAnalysis analysis;
+    const bool is_analyzed = analyzeSprites(
+        _sprites,
+        _options,
+        _context,
+        statistics,
+        analysis,
+        [&_context, sprite_count](PackPhase __phase, qsizetype __done) {
+            const int pass = __phase == PackPhase::Crop ? CropPass : HashPass;
+            _context.setProgressValue(pass * sprite_count + static_cast<int>(__done));
+        });
+    if(!is_analyzed)
+        return nullptr;
+    const QList<QRect> & sprite_rects = analysis.rects;
+    const QList<qsizetype> & originals = analysis.originals;
+    // Cells are whole blocks, so the bin is cut down to whole blocks as well
+    const QSize bin_size = alignAtlasSize(_options.max_atlas_size, _options.block_size);
+
+    QList<Bin> bins(1);
+    QList<std::optional<GridOptions>> grids;
     {
-        if(isCanceled(_promise))
-            return nullptr;
-        const QString sprite_name = _options.remove_file_extensions
-            ? QFileInfo(sprite.name).baseName()
-            : QFileInfo(sprite.name).fileName();
-        QByteArray hash_sum;
-        const Item * duplicate = nullptr;
-        if(_options.detect_duplicates)
+        PackPhaseTimer timer(statistics.phase(PackPhase::Placement));
+        const PlacementInput input
+        {
+            .sprites = _sprites,
+            .images = analysis.images,
+            .sprite_rects = sprite_rects,
+            .originals = originals,
+            .orientations = analysis.orientations,
+            .order = _order,
+            .options = _options
+        };
+        const std::optional<GridLayout> grid_layout = _allow_grid_layout && _options.block_size <= 1
+            ? planGridLayout(sprite_rects, originals, _options.max_atlas_size)
+            : std::nullopt;
+        const int partition_count = m_partition_count > 0 ? m_partition_count : QThread::idealThreadCount();
+        if(grid_layout)
         {
-            hash_sum = QCryptographicHash::hash(
-                QByteArrayView(sprite.image.constBits(), sprite.image.sizeInBytes()),
-                QCryptographicHash::Md5);
-            duplicate = findDuplicate(items, hash_sum);
+            bins.resize(grid_layout->bin_sizes.count());
+            grids = grid_layout->grids;
+            for(qsizetype i = 0; i < _sprites.count(); ++i)
+            {
+                if(_context.isCanceled())
+                    return nullptr;
+                _context.setProgressValue(PlacementPass * sprite_count + static_cast<int>(i));
+                const Sprite & sprite = _sprites[i];
+                const QRect & sprite_rect = sprite_rects[i];
+                PlacedSprite placed_sprite
+                {
+                    .image = originals[i] == i ? &analysis.images[i] : nullptr,
+                    .frame =
+                    {
+                        .texture_rect = QRect(grid_layout->positions[i], sprite_rects[originals[i]].size()),
+                        .sprite_rect = QRect(sprite_rect.topLeft(), analysis.images[i].size()),
+                        .name = makeSpriteName(sprite, _options),
+                        .is_rotated = false,
+                        .is_flipped_horizontally = false,
+                        .is_flipped_vertically = false
+                    }
+                };
+                orientFrame(placed_sprite.frame, analysis.orientations[i]);
+                bins[grid_layout->bins[i]].append(placed_sprite);
+            }
+            if(exceedsBound(_context, bins, _options))
+                return nullptr;
         }
-        if(duplicate)
+        else if(partition_count > 1 && _sprites.count() >= partition_count * g_min_partition_sprite_count)
         {
-            items.push_back(*duplicate);
-            Item & item = items.back();
-            item.image = nullptr;
-            item.name = sprite_name;
+            // Each partition fills bins of its own on a worker thread. The last bins of the partitions are
+            // only partially filled, so their sprites are packed again together.
+            std::vector<Partition> partitions = partitionSprites(input, partition_count);
+            for(Partition & partition : partitions)
+                partition.algorithm = createAlgorithm(bin_size);
+            _context.setProgressValue(PlacementPass * sprite_count);
+            QtConcurrent::blockingMap(partitions, [&](Partition & __partition) {
+                qsizetype placed_count = 0;
+                __partition.status = placeSprites(
+                    *__partition.algorithm,
+                    input,
+                    __partition.positions,
+                    __partition.bins,
+                    [&](qsizetype) {
+                        ++placed_count;
+                        return !_context.isCanceled();
+                    },
+                    [&](qsizetype) {
+                        __partition.last_bin_start = placed_count - 1;
+                        return true;
+                    });
+            });
+            bins.clear();
+            QList<qsizetype> tail_positions;
+            for(Partition & partition : partitions)
+            {
+                if(partition.status == PlacementStatus::OversizedSprite)
+                    throw InvalidOperationExeption(tr("The sprite exceeds the texture size limit"));
+                if(partition.status == PlacementStatus::Stopped)
+                    return nullptr;
+                bins.append(partition.bins.first(partition.bins.count() - 1));
+                tail_positions.append(partition.positions.sliced(partition.last_bin_start));
+            }
+            std::sort(tail_positions.begin(), tail_positions.end());
+            _context.setProgressValue(PlacementPass * sprite_count + (sprite_count - static_cast<int>(tail_positions.count())));
+            std::unique_ptr<AtlasPackerOnlineAlgorithm> algorithm = createAlgorithm(bin_size);
+            QList<Bin> tail_bins;
+            const PlacementStatus status = placeSprites(
+                *algorithm,
+                input,
+                tail_positions,
+                tail_bins,
+                [&_context](qsizetype) { return !_context.isCanceled(); },
+                [](qsizetype) { return true; });
+            if(status == PlacementStatus::Stopped)
+                return nullptr;
+            bins.append(tail_bins);
+            if(exceedsBound(_context, bins, _options))
+                return nullptr;
         }
         else
         {
-            QRect sprite_rect = _options.crop ? crop(sprite.image) : sprite.image.rect();
-        RETRY:
-            QRect texture_rect = algorithm->insert(sprite_rect.width(), sprite_rect.height());
-            if(texture_rect.isNull())
+            // Bins take consecutive sprites, so the unique area left for the open bin and the next ones is a suffix sum
+            AtlasPackBound bound { .max_atlas_size = _options.max_atlas_size };
+            QList<qint64> remaining_areas;
+            if(_context.hasBoundCallback())
             {
-                if(items.empty())
+                remaining_areas.resize(_sprites.count() + 1);
+                remaining_areas[_sprites.count()] = 0;
+                for(qsizetype k = _sprites.count() - 1; k >= 0; --k)
                 {
-                    throw InvalidOperationExeption(tr("The sprite exceeds the texture size limit"));
+                    const qsizetype i = _order.indices[k];
+                    const qint64 area = originals[i] == i
+                        ? static_cast<qint64>(sprite_rects[i].width()) * sprite_rects[i].height()
+                        : 0;
+                    remaining_areas[k] = remaining_areas[k + 1] + area;
                 }
-                result->add({
-                    .image = render(items),
-                    .frames = itemsToFrames(items)
-                });
-                items.clear();
-                algorithm->resetBin();
-                goto RETRY;
+                bound.remaining_sprite_area = remaining_areas[0];
+                if(_context.isBoundExceeded(bound))
+                    return nullptr;
             }
-            items.emplace_back(
-                &sprite.image,
-                sprite_name,
-                QRect(
-                    sprite_rect.x(),
-                    sprite_rect.y(),
-                    sprite.image.rect().width(),
-                    sprite.image.rect().height()),
-                texture_rect,
-                texture_rect.width() == sprite_rect.height());
-            if(_options.detect_duplicates)
-                items.back().hash_sum = hash_sum;
+            std::unique_ptr<AtlasPackerOnlineAlgorithm> algorithm = createAlgorithm(bin_size);
+            QList<qsizetype> positions(_sprites.count());
+            std::iota(positions.begin(), positions.end(), 0);
+            const PlacementStatus status = placeSprites(
+                *algorithm,
+                input,
+                positions,
+                bins,
+                [&](qsizetype __position) {
+                    if(_context.isCanceled())
+                        return false;
+                    _context.setProgressValue(PlacementPass * sprite_count + static_cast<int>(__position));
+                    return true;
+                },
+                [&](qsizetype __position) {
+                    if(!_context.hasBoundCallback())
+                        return true;
+                    bound.closed_atlas_sizes.append(calculateBinSize(bins.last()));
+                    bound.remaining_sprite_area = remaining_areas[__position];
+                    return !_context.isBoundExceeded(bound);
+                });
+            if(status == PlacementStatus::OversizedSprite)
+                throw InvalidOperationExeption(tr("The sprite exceeds the texture size limit"));
+            if(status == PlacementStatus::Stopped)
+                return nullptr;
+        }
+        for(const Bin & bin : bins)
+        {
+            statistics.duplicate_count += std::count_if(bin.cbegin(), bin.cend(), [](const PlacedSprite & __sprite) {
+                return __sprite.image == nullptr;
+            });
         }
     }
-    if(!items.empty())
+
     {
-        result->add({
-            .image = render(items),
-            .frames = itemsToFrames(items)
-        });
+        PackPhaseTimer timer(statistics.phase(PackPhase::Render));
+        int rendered_sprite_count = 0;
+        for(qsizetype bin_index = 0; bin_index < bins.count(); ++bin_index)
+        {
+            const Bin & bin = bins[bin_index];
+            if(bin.empty())
+                continue;
+            if(_context.isCanceled())
+                return nullptr;
+            _context.setProgressValue(RenderPass * sprite_count + rendered_sprite_count);
+            rendered_sprite_count += static_cast<int>(bin.count());
+            const QImage image = renderSprites(bin, &_context, _options.premultiply_alpha);
+            if(_context.isCanceled())
+                return nullptr;
+            RawAtlas atlas
+            {
+                .image = image,
+                .frames = binToFrames(bin),
+                .grid = bin_index < grids.count() && isUntrimmed(bin) ? grids[bin_index] : std::nullopt,
+                .content = analyzeTextureContent(image)
+            };
+            statistics.occupancy.append(calculateOccupancy(bin, atlas.image));
+            result->add(std::move(atlas));
+        }
     }
+    statistics.bin_count = static_cast<qsizetype>(result->count());
+    _context.setProgressValue(ProgressPassCount * sprite_count);
     return result;
 }
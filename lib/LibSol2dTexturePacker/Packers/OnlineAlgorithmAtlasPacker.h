@@ -20,6 +20,13 @@
 
 #include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
 
+// Native engines place sprites exactly like RectangleBinPack, but scale better with the number of sprites
+enum class S2TP_EXPORT OnlineAlgorithmEngine
+{
+    Native,
+    RectangleBinPack
+};
+
 class S2TP_EXPORT AtlasPackerOnlineAlgorithm
 {
 public:
@@ -28,23 +35,64 @@ public:
     virtual void resetBin() = 0;
 };
 
+// The order in which sprites are placed and whether each sprite is turned by 90 degrees before placement
+struct S2TP_EXPORT SpritePlacementOrder
+{
+    QList<qsizetype> indices;
+    QList<bool> rotations;
+};
+
 class S2TP_EXPORT OnlineAlgorithmAtlasPacker : public AtlasPacker
 {
 public:
     explicit OnlineAlgorithmAtlasPacker(QObject * _parent) :
         AtlasPacker(_parent),
-        m_max_atlas_size{1024, 1024}
+        m_max_atlas_size{1024, 1024},
+        m_engine(OnlineAlgorithmEngine::Native),
+        m_is_grid_layout_enabled(true),
+        m_partition_count(1)
     {
     }
 
+    void setEngine(OnlineAlgorithmEngine _engine) { m_engine = _engine; }
+    OnlineAlgorithmEngine engine() const { return m_engine; }
+    // Sprites of a few distinct sizes are laid out in rows without running the algorithm.
+    // Only applies when the packer chooses the order of the sprites itself.
+    void enableGridLayout(bool _enable) { m_is_grid_layout_enabled = _enable; }
+    bool isGridLayoutEnabled() const { return m_is_grid_layout_enabled; }
+    // Large sets are split into partitions of similar area that are packed concurrently, then the partially
+    // filled last bins of the partitions are packed again together. It is faster, but the atlases are
+    // filled slightly worse. Zero means one partition per processor core.
+    void setPartitionCount(int _count) { m_partition_count = _count; }
+    int partitionCount() const { return m_partition_count; }
+
     std::unique_ptr<RawAtlasPack> pack(
-        QPromise<void> & _promise,
+        AtlasPackerContext & _context,
         const QList<Sprite> & _sprites,
         const AtlasPackerOptions & _options) const override;
 
+    std::unique_ptr<RawAtlasPack> pack(
+        AtlasPackerContext & _context,
+        const QList<Sprite> & _sprites,
+        const AtlasPackerOptions & _options,
+        const SpritePlacementOrder & _order) const;
+
 protected:
     virtual std::unique_ptr<AtlasPackerOnlineAlgorithm> createAlgorithm(const QSize & _max_atlas_size) const = 0;
 
+private:
+    std::unique_ptr<RawAtlasPack> pack(
+        AtlasPackerContext & _context,
+        const QList<Sprite> & _sprites,
+        const AtlasPackerOptions & _options,
+        const SpritePlacementOrder & _order,
+        bool _allow_grid_layout) const;
+
 protected:
     QSize m_max_atlas_size;
+    OnlineAlgorithmEngine m_engine;
+
+private:
+    bool m_is_grid_layout_enabled;
+    int m_partition_count;
 };
@@ -0,0 +1,130 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/PackStatistics.h>
+#include <QJsonArray>
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <time.h>
+#endif
+
+namespace {
+
+// CPU time of the whole process, so that work done by worker threads is accounted for as well.
+// It is only a figure of the pack while nothing else runs in the process.
+qint64 processCpuTime()
+{
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if(!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+        return 0;
+    auto to_ns = [](const FILETIME & __time) {
+        return ((static_cast<qint64>(__time.dwHighDateTime) << 32) | __time.dwLowDateTime) * 100;
+    };
+    return to_ns(kernel_time) + to_ns(user_time);
+#else
+    timespec time;
+    if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+        return 0;
+    return static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+}
+
+double toMilliseconds(qint64 _ns)
+{
+    return static_cast<double>(_ns) / 1000000.0;
+}
+
+} // namespace
+
+void PackStatistics::addPhases(const PackStatistics & _statistics)
+{
+    for(int i = 0; i < phase_count; ++i)
+    {
+        phases[i].wall_ns += _statistics.phases[i].wall_ns;
+        phases[i].cpu_ns += _statistics.phases[i].cpu_ns;
+    }
+}
+
+QString PackStatistics::phaseName(PackPhase _phase)
+{
+    switch(_phase)
+    {
+    case PackPhase::Decode:
+        return "decode";
+    case PackPhase::Crop:
+        return "crop";
+    case PackPhase::Hash:
+        return "hash";
+    case PackPhase::Placement:
+        return "placement";
+    case PackPhase::Render:
+        return "render";
+    case PackPhase::Downscale:
+        return "downscale";
+    case PackPhase::Encode:
+        return "encode";
+    case PackPhase::WriteXml:
+        return "write_xml";
+    default:
+        return QString();
+    }
+}
+
+QJsonObject PackStatistics::toJson() const
+{
+    QJsonObject json_phases;
+    for(int i = 0; i < phase_count; ++i)
+    {
+        json_phases.insert(phaseName(static_cast<PackPhase>(i)), QJsonObject {
+            { "wall_ms", toMilliseconds(phases[i].wall_ns) },
+            { "cpu_ms", toMilliseconds(phases[i].cpu_ns) }
+        });
+    }
+    QJsonArray json_occupancy;
+    for(double value : occupancy)
+        json_occupancy.append(value);
+    return QJsonObject
+    {
+        { "phases", json_phases },
+        { "sprites", static_cast<qint64>(sprite_count) },
+        { "duplicates", static_cast<qint64>(duplicate_count) },
+        { "bins", static_cast<qint64>(bin_count) },
+        { "trials", static_cast<qint64>(trial_count) },
+        { "pruned_trials", static_cast<qint64>(pruned_trial_count) },
+        { "optimal", is_optimal },
+        { "occupancy", json_occupancy },
+        { "bytes_written", bytes_written }
+    };
+}
+
+PackPhaseTimer::PackPhaseTimer(PackPhaseTime & _time) :
+    m_time(_time),
+    m_cpu_start_ns(processCpuTime())
+{
+    m_wall_timer.start();
+}
+
+PackPhaseTimer::~PackPhaseTimer()
+{
+    m_time.wall_ns += m_wall_timer.nsecsElapsed();
+    m_time.cpu_ns += processCpuTime() - m_cpu_start_ns;
+}
@@ -0,0 +1,81 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Def.h>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <array>
+
+enum class S2TP_EXPORT PackPhase
+{
+    Decode,
+    Crop,
+    Hash,
+    Placement,
+    Render,
+    Downscale,
+    Encode,
+    WriteXml
+};
+
+struct S2TP_EXPORT PackPhaseTime
+{
+    qint64 wall_ns = 0;
+    // CPU time of the whole process during the phase, the worker threads included.
+    // Anything else the process runs at the same time is counted as well.
+    qint64 cpu_ns = 0;
+};
+
+struct S2TP_EXPORT PackStatistics
+{
+    static constexpr int phase_count = static_cast<int>(PackPhase::WriteXml) + 1;
+
+    std::array<PackPhaseTime, phase_count> phases {};
+    qsizetype sprite_count = 0;
+    qsizetype duplicate_count = 0;
+    qsizetype bin_count = 0;
+    qsizetype trial_count = 0;
+    qsizetype pruned_trial_count = 0;
+    // The packer has proven that no smaller layout exists within its search space
+    bool is_optimal = false;
+    QList<double> occupancy;
+    qint64 bytes_written = 0;
+
+    PackPhaseTime & phase(PackPhase _phase) { return phases[static_cast<size_t>(_phase)]; }
+    const PackPhaseTime & phase(PackPhase _phase) const { return phases[static_cast<size_t>(_phase)]; }
+    void addPhases(const PackStatistics & _statistics);
+    QJsonObject toJson() const;
+    static QString phaseName(PackPhase _phase);
+};
+
+class S2TP_EXPORT PackPhaseTimer final
+{
+    Q_DISABLE_COPY_MOVE(PackPhaseTimer)
+
+public:
+    explicit PackPhaseTimer(PackPhaseTime & _time);
+    ~PackPhaseTimer();
+
+private:
+    PackPhaseTime & m_time;
+    QElapsedTimer m_wall_timer;
+    qint64 m_cpu_start_ns;
+};
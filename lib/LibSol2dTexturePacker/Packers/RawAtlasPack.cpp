@@ -17,18 +17,35 @@
  **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Packers/RawAtlasPack.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
 #include <LibSol2dTexturePacker/Atlas/Sol2dAtlasSerializer.h>
 #include <LibSol2dTexturePacker/Exception.h>
+#include <QFileInfo>
+
+std::unique_ptr<RawAtlasPack> RawAtlasPack::clone() const
+{
+    std::unique_ptr<RawAtlasPack> pack = std::make_unique<RawAtlasPack>();
+    pack->m_atlases = m_atlases;
+    pack->m_statistics = m_statistics;
+    return pack;
+}
 
 void RawAtlasPack::save(
     const QDir & _directory,
     const QString & _atlas_name,
     const QString & _image_format,
-    const QString & _color_to_alpha)
+    const QString & _color_to_alpha,
+    const TextureOptions & _texture_options)
 {
     if(m_atlases.empty())
         return;
 
+    PackPhaseTime & encode_time = m_statistics.phase(PackPhase::Encode);
+    PackPhaseTime & write_xml_time = m_statistics.phase(PackPhase::WriteXml);
+    encode_time = {};
+    write_xml_time = {};
+    m_statistics.bytes_written = 0;
+
     Sol2dAtlasSerializer serializer;
     size_t index = m_atlases.size() == 1 ? 0 : 1;
     for(const RawAtlas & ra : m_atlases)
@@ -36,17 +53,51 @@ void RawAtlasPack::save(
         const QString base_filename = _directory.absoluteFilePath(index == 0
             ? _atlas_name
             : QString("%1-%2").arg(_atlas_name).arg(index));
+        TextureOptions texture_options = _texture_options;
+        if(texture_options.strip_opaque_alpha &&
+            texture_options.pixel_format == TexturePixelFormat::RGBA8888 &&
+            texture_options.compression == TextureCompression::None &&
+            ra.content.is_opaque)
+        {
+            texture_options.pixel_format = ra.content.is_grayscale ? TexturePixelFormat::L8 : TexturePixelFormat::RGB888;
+        }
         Atlas atlas
         {
             .texture = QString("%1.%2").arg(base_filename, _image_format),
             .color_to_alpha = _color_to_alpha,
-            .frames = ra.frames
+            .pixel_format = texture_options.pixel_format,
+            .compression = texture_options.compression,
+            .is_alpha_premultiplied = ra.image.format() == QImage::Format_RGBA8888_Premultiplied,
+            .frames = ra.frames,
+            .grid = ra.grid
         };
+        const QString data_file = _directory.absoluteFilePath(
+            QString("%1.%2").arg(base_filename, serializer.defaultFileExtenstion()));
         ++index;
-        if(!ra.image.save(atlas.texture))
-            throw ImageSavingException(atlas.texture);
-        serializer.serialize(
-            atlas,
-            _directory.absoluteFilePath(QString("%1.%2").arg(base_filename, serializer.defaultFileExtenstion())));
+        {
+            PackPhaseTimer timer(encode_time);
+            // Image files have no premultiplied formats, the values are written as they are and
+            // the atlas data tells readers how to take them
+            const QImage source = atlas.is_alpha_premultiplied
+                ? QImage(ra.image.constBits(), ra.image.width(), ra.image.height(), ra.image.bytesPerLine(), g_sprite_image_format)
+                : ra.image;
+            const QImage texture = quantizeTexture(source, texture_options);
+            if(texture.format() == QImage::Format_Indexed8)
+                atlas.palette_size = static_cast<int>(texture.colorCount());
+            if(texture_options.compression != TextureCompression::None)
+                saveCompressedTexture(
+                    texture,
+                    texture_options.compression,
+                    atlas.is_alpha_premultiplied,
+                    _image_format,
+                    atlas.texture);
+            else if(!texture.save(atlas.texture))
+                throw ImageSavingException(atlas.texture);
+        }
+        {
+            PackPhaseTimer timer(write_xml_time);
+            serializer.serialize(atlas, data_file);
+        }
+        m_statistics.bytes_written += QFileInfo(atlas.texture).size() + QFileInfo(data_file).size();
     }
 }
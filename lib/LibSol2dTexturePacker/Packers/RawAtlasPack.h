@@ -19,14 +19,25 @@
 #pragma once
 
 #include <LibSol2dTexturePacker/Frame.h>
+#include <LibSol2dTexturePacker/Packers/PackStatistics.h>
+#include <LibSol2dTexturePacker/Packers/TextureQuantizer.h>
+#include <LibSol2dTexturePacker/Packers/TextureContent.h>
+#include <LibSol2dTexturePacker/Pack/GridPack.h>
 #include <QImage>
 #include <QDir>
 #include <list>
+#include <memory>
+#include <optional>
 
 struct S2TP_EXPORT RawAtlas
 {
     QImage image;
     QList<Frame> frames;
+    // Set when the frames form a grid that GridPack reads back, cells past the last frame are empty.
+    // The grid is saved with the atlas data.
+    std::optional<GridOptions> grid;
+    // Found when the atlas is rendered, the alpha channel can be dropped when it is opaque
+    TextureContent content;
 };
 
 class S2TP_EXPORT RawAtlasPack final
@@ -39,19 +50,24 @@ public:
 
 public:
     RawAtlasPack() { }
+    std::unique_ptr<RawAtlasPack> clone() const;
 
     void save(
         const QDir & _directory,
         const QString & _atlas_name,
         const QString & _image_format,
-        const QString & _color_to_alpha);
+        const QString & _color_to_alpha,
+        const TextureOptions & _texture_options);
 
     void add(RawAtlas && _atlas){ m_atlases.emplace_back(std::move(_atlas)); }
     void add(const RawAtlas & _atlas) { m_atlases.push_back(_atlas); }
     size_t count() const { return m_atlases.size(); }
     std::list<RawAtlas>::const_iterator begin() const { return m_atlases.cbegin(); }
     std::list<RawAtlas>::const_iterator end() const { return m_atlases.end(); }
+    const PackStatistics & statistics() const { return m_statistics; }
+    PackStatistics & statistics() { return m_statistics; }
 
 private:
     std::list<RawAtlas> m_atlases;
+    PackStatistics m_statistics;
 };
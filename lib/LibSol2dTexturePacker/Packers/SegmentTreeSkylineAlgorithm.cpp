@@ -0,0 +1,247 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/SegmentTreeSkylineAlgorithm.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+void SegmentTreeSkylineAlgorithm::HeightTree::reset(int _width)
+{
+    m_width = _width;
+    m_nodes.assign(4 * static_cast<size_t>(std::max(1, _width)), Node { .max = 0, .sum = 0, .assigned = 0 });
+}
+
+void SegmentTreeSkylineAlgorithm::HeightTree::assign(int _from, int _to, int _height)
+{
+    if(_from < _to)
+        assign(1, 0, m_width, _from, _to, _height);
+}
+
+int SegmentTreeSkylineAlgorithm::HeightTree::max(int _from, int _to) const
+{
+    return _from < _to ? max(1, 0, m_width, _from, _to) : 0;
+}
+
+qint64 SegmentTreeSkylineAlgorithm::HeightTree::sum(int _from, int _to) const
+{
+    return _from < _to ? sum(1, 0, m_width, _from, _to) : 0;
+}
+
+void SegmentTreeSkylineAlgorithm::HeightTree::assign(int _index, int _left, int _right, int _from, int _to, int _height)
+{
+    if(_to <= _left || _right <= _from)
+        return;
+    if(_from <= _left && _right <= _to)
+    {
+        apply(_index, _left, _right, _height);
+        return;
+    }
+    push(_index, _left, _right);
+    const int middle = _left + (_right - _left) / 2;
+    assign(2 * _index, _left, middle, _from, _to, _height);
+    assign(2 * _index + 1, middle, _right, _from, _to, _height);
+    Node & node = m_nodes[_index];
+    node.max = std::max(m_nodes[2 * _index].max, m_nodes[2 * _index + 1].max);
+    node.sum = m_nodes[2 * _index].sum + m_nodes[2 * _index + 1].sum;
+}
+
+int SegmentTreeSkylineAlgorithm::HeightTree::max(int _index, int _left, int _right, int _from, int _to) const
+{
+    if(_to <= _left || _right <= _from)
+        return 0;
+    const Node & node = m_nodes[_index];
+    if(_from <= _left && _right <= _to)
+        return node.max;
+    if(node.assigned >= 0)
+        return node.assigned;
+    const int middle = _left + (_right - _left) / 2;
+    return std::max(
+        max(2 * _index, _left, middle, _from, _to),
+        max(2 * _index + 1, middle, _right, _from, _to));
+}
+
+qint64 SegmentTreeSkylineAlgorithm::HeightTree::sum(int _index, int _left, int _right, int _from, int _to) const
+{
+    if(_to <= _left || _right <= _from)
+        return 0;
+    const Node & node = m_nodes[_index];
+    if(_from <= _left && _right <= _to)
+        return node.sum;
+    if(node.assigned >= 0)
+        return static_cast<qint64>(node.assigned) * (std::min(_right, _to) - std::max(_left, _from));
+    const int middle = _left + (_right - _left) / 2;
+    return
+        sum(2 * _index, _left, middle, _from, _to) +
+        sum(2 * _index + 1, middle, _right, _from, _to);
+}
+
+void SegmentTreeSkylineAlgorithm::HeightTree::apply(int _index, int _left, int _right, int _height)
+{
+    Node & node = m_nodes[_index];
+    node.max = _height;
+    node.sum = static_cast<qint64>(_height) * (_right - _left);
+    node.assigned = _height;
+}
+
+void SegmentTreeSkylineAlgorithm::HeightTree::push(int _index, int _left, int _right)
+{
+    Node & node = m_nodes[_index];
+    if(node.assigned < 0)
+        return;
+    const int middle = _left + (_right - _left) / 2;
+    apply(2 * _index, _left, middle, node.assigned);
+    apply(2 * _index + 1, middle, _right, node.assigned);
+    node.assigned = -1;
+}
+
+SegmentTreeSkylineAlgorithm::SegmentTreeSkylineAlgorithm(
+    const QSize & _bin_size,
+    SkylineBinAtlasPackerLevelChoiceHeuristic _heuristic
+) :
+    m_bin_size(_bin_size),
+    m_heuristic(_heuristic)
+{
+    resetBin();
+}
+
+void SegmentTreeSkylineAlgorithm::resetBin()
+{
+    m_skyline.clear();
+    m_skyline.push_back({ .x = 0, .y = 0, .width = m_bin_size.width() });
+    m_heights.reset(m_bin_size.width());
+}
+
+QRect SegmentTreeSkylineAlgorithm::insert(int _width, int _height)
+{
+    Placement placement;
+    switch(m_heuristic)
+    {
+    case SkylineBinAtlasPackerLevelChoiceHeuristic::BottomLeft:
+        placement = findPositionBottomLeft(_width, _height);
+        break;
+    case SkylineBinAtlasPackerLevelChoiceHeuristic::MinWasteFit:
+        placement = findPositionMinWaste(_width, _height);
+        break;
+    default:
+        throw std::runtime_error("Unknown SkylineBinAtlasPackerLevelChoiceHeuristic");
+    }
+    if(placement.node_index < 0)
+        return QRect();
+    addSkylineLevel(placement.node_index, placement.rect);
+    return placement.rect;
+}
+
+bool SegmentTreeSkylineAlgorithm::fits(const SkylineNode & _node, int _width, int _height, int * _y) const
+{
+    if(_node.x + _width > m_bin_size.width())
+        return false;
+    *_y = m_heights.max(_node.x, _node.x + _width);
+    return *_y + _height <= m_bin_size.height();
+}
+
+SegmentTreeSkylineAlgorithm::Placement SegmentTreeSkylineAlgorithm::findPositionBottomLeft(
+    int _width,
+    int _height) const
+{
+    Placement placement { .rect = QRect(), .node_index = -1 };
+    int best_height = std::numeric_limits<int>::max();
+    int best_width = std::numeric_limits<int>::max();
+    const auto consider = [&](int __index, int __width, int __height) {
+        const SkylineNode & node = m_skyline[__index];
+        // The sprite cannot rest lower than the node, so the range query is skipped for hopeless nodes
+        if(node.y + __height > best_height)
+            return;
+        int y;
+        if(!fits(node, __width, __height, &y))
+            return;
+        if(y + __height < best_height || (y + __height == best_height && node.width < best_width))
+        {
+            best_height = y + __height;
+            best_width = node.width;
+            placement = { .rect = QRect(node.x, y, __width, __height), .node_index = __index };
+        }
+    };
+    for(int i = 0; i < static_cast<int>(m_skyline.size()); ++i)
+    {
+        consider(i, _width, _height);
+        consider(i, _height, _width);
+    }
+    return placement;
+}
+
+SegmentTreeSkylineAlgorithm::Placement SegmentTreeSkylineAlgorithm::findPositionMinWaste(
+    int _width,
+    int _height) const
+{
+    Placement placement { .rect = QRect(), .node_index = -1 };
+    int best_height = std::numeric_limits<int>::max();
+    qint64 best_wasted_area = std::numeric_limits<qint64>::max();
+    const auto consider = [&](int __index, int __width, int __height) {
+        const SkylineNode & node = m_skyline[__index];
+        int y;
+        if(!fits(node, __width, __height, &y))
+            return;
+        const qint64 wasted_area =
+            static_cast<qint64>(__width) * y - m_heights.sum(node.x, node.x + __width);
+        if(wasted_area < best_wasted_area || (wasted_area == best_wasted_area && y + __height < best_height))
+        {
+            best_height = y + __height;
+            best_wasted_area = wasted_area;
+            placement = { .rect = QRect(node.x, y, __width, __height), .node_index = __index };
+        }
+    };
+    for(int i = 0; i < static_cast<int>(m_skyline.size()); ++i)
+    {
+        consider(i, _width, _height);
+        consider(i, _height, _width);
+    }
+    return placement;
+}
+
+void SegmentTreeSkylineAlgorithm::addSkylineLevel(int _node_index, const QRect & _rect)
+{
+    const int level = _rect.y() + _rect.height();
+    m_heights.assign(_rect.x(), _rect.x() + _rect.width(), level);
+    m_skyline.insert(m_skyline.begin() + _node_index, { .x = _rect.x(), .y = level, .width = _rect.width() });
+
+    // Cut the nodes covered by the new level
+    const int right = _rect.x() + _rect.width();
+    const auto next = m_skyline.begin() + _node_index + 1;
+    auto covered_end = next;
+    while(covered_end != m_skyline.end() && covered_end->x + covered_end->width <= right)
+        ++covered_end;
+    if(covered_end != m_skyline.end() && covered_end->x < right)
+    {
+        covered_end->width -= right - covered_end->x;
+        covered_end->x = right;
+    }
+    m_skyline.erase(next, covered_end);
+
+    // The skyline was merged before, so only the new level can have neighbours of the same height
+    if(_node_index + 1 < static_cast<int>(m_skyline.size()) && m_skyline[_node_index + 1].y == level)
+    {
+        m_skyline[_node_index].width += m_skyline[_node_index + 1].width;
+        m_skyline.erase(m_skyline.begin() + _node_index + 1);
+    }
+    if(_node_index > 0 && m_skyline[_node_index - 1].y == level)
+    {
+        m_skyline[_node_index - 1].width += m_skyline[_node_index].width;
+        m_skyline.erase(m_skyline.begin() + _node_index);
+    }
+}
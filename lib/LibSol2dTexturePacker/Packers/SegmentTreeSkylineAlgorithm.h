@@ -0,0 +1,87 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/SkylineBinAtlasPacker.h>
+#include <vector>
+
+// Skyline with the level choice, scores and tie-breaking of rbp::SkylineBinPack (without the waste map).
+// The heights of the skyline are mirrored in a segment tree, so the height a sprite rests on and the area
+// it wastes are found in logarithmic time instead of walking every skyline node under the sprite.
+class S2TP_EXPORT SegmentTreeSkylineAlgorithm final : public AtlasPackerOnlineAlgorithm
+{
+private:
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Placement
+    {
+        QRect rect;
+        int node_index;
+    };
+
+    class HeightTree
+    {
+    public:
+        void reset(int _width);
+        void assign(int _from, int _to, int _height);
+        int max(int _from, int _to) const;
+        qint64 sum(int _from, int _to) const;
+
+    private:
+        struct Node
+        {
+            int max;
+            qint64 sum;
+            // The height all columns of the node are assigned to, -1 when the children hold the heights
+            int assigned;
+        };
+
+    private:
+        void assign(int _index, int _left, int _right, int _from, int _to, int _height);
+        int max(int _index, int _left, int _right, int _from, int _to) const;
+        qint64 sum(int _index, int _left, int _right, int _from, int _to) const;
+        void apply(int _index, int _left, int _right, int _height);
+        void push(int _index, int _left, int _right);
+
+    private:
+        int m_width = 0;
+        std::vector<Node> m_nodes;
+    };
+
+public:
+    SegmentTreeSkylineAlgorithm(const QSize & _bin_size, SkylineBinAtlasPackerLevelChoiceHeuristic _heuristic);
+    QRect insert(int _width, int _height) override;
+    void resetBin() override;
+
+private:
+    Placement findPositionBottomLeft(int _width, int _height) const;
+    Placement findPositionMinWaste(int _width, int _height) const;
+    bool fits(const SkylineNode & _node, int _width, int _height, int * _y) const;
+    void addSkylineLevel(int _node_index, const QRect & _rect);
+
+private:
+    QSize m_bin_size;
+    SkylineBinAtlasPackerLevelChoiceHeuristic m_heuristic;
+    std::vector<SkylineNode> m_skyline;
+    HeightTree m_heights;
+};
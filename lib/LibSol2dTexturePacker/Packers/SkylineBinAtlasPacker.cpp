@@ -17,15 +17,16 @@
  **********************************************************************************************************/
 
 #include <LibSol2dTexturePacker/Packers/SkylineBinAtlasPacker.h>
+#include <LibSol2dTexturePacker/Packers/SegmentTreeSkylineAlgorithm.h>
 #include <RectangleBinPack/SkylineBinPack.h>
 #include <QPainter>
 
 namespace {
 
-class SkylineBinPackAlgorithm : public AtlasPackerOnlineAlgorithm
+class RbpSkylineBinPackAlgorithm : public AtlasPackerOnlineAlgorithm
 {
 public:
-    SkylineBinPackAlgorithm(
+    RbpSkylineBinPackAlgorithm(
         const QSize & _max_atlas_size,
         SkylineBinAtlasPackerLevelChoiceHeuristic _heuristic,
         bool _use_waste_map);
@@ -42,7 +43,7 @@ private:
     bool m_use_waste_map;
 };
 
-SkylineBinPackAlgorithm::SkylineBinPackAlgorithm(
+RbpSkylineBinPackAlgorithm::RbpSkylineBinPackAlgorithm(
     const QSize & _max_atlas_size,
     SkylineBinAtlasPackerLevelChoiceHeuristic _heuristic,
     bool _use_waste_map
@@ -54,7 +55,7 @@ SkylineBinPackAlgorithm::SkylineBinPackAlgorithm(
 {
 }
 
-rbp::SkylineBinPack::LevelChoiceHeuristic SkylineBinPackAlgorithm::map(
+rbp::SkylineBinPack::LevelChoiceHeuristic RbpSkylineBinPackAlgorithm::map(
     SkylineBinAtlasPackerLevelChoiceHeuristic _heuristic)
 {
     switch(_heuristic)
@@ -70,13 +71,13 @@ rbp::SkylineBinPack::LevelChoiceHeuristic SkylineBinPackAlgorithm::map(
 
 } // namespace
 
-QRect SkylineBinPackAlgorithm::insert(int _width, int _height)
+QRect RbpSkylineBinPackAlgorithm::insert(int _width, int _height)
 {
     rbp::Rect rect = m_pack.Insert(_width, _height, m_heuristic);
     return QRect(rect.x, rect.y, rect.width, rect.height);
 }
 
-void SkylineBinPackAlgorithm::resetBin()
+void RbpSkylineBinPackAlgorithm::resetBin()
 {
     m_pack.Init(m_max_atlas_size.width(), m_max_atlas_size.height(), m_use_waste_map);
 }
@@ -90,6 +91,9 @@ SkylineBinAtlasPacker::SkylineBinAtlasPacker(QObject *_parent) :
 
 std::unique_ptr<AtlasPackerOnlineAlgorithm> SkylineBinAtlasPacker::createAlgorithm(const QSize & _max_atlas_size) const
 {
+    // The native engine has no waste map
+    if(m_engine == OnlineAlgorithmEngine::Native && !m_use_waste_map)
+        return std::make_unique<SegmentTreeSkylineAlgorithm>(_max_atlas_size, m_heuristic);
     return std::unique_ptr<AtlasPackerOnlineAlgorithm>(
-        new SkylineBinPackAlgorithm(_max_atlas_size, m_heuristic, m_use_waste_map));
+        new RbpSkylineBinPackAlgorithm(_max_atlas_size, m_heuristic, m_use_waste_map));
 }
@@ -0,0 +1,559 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Def.h>
+#include <QHash>
+#include <QThread>
+#include <QTransform>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#ifdef S2TP_SSE2
+#   include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr qsizetype g_sprites_per_thread_batch = 16;
+
+// The identity goes first, it is the cheapest to check
+constexpr SpriteOrientation g_orientations[] =
+{
+    { .is_rotated = false, .is_flipped_horizontally = false, .is_flipped_vertically = false },
+    { .is_rotated = false, .is_flipped_horizontally = true, .is_flipped_vertically = false },
+    { .is_rotated = false, .is_flipped_horizontally = false, .is_flipped_vertically = true },
+    { .is_rotated = false, .is_flipped_horizontally = true, .is_flipped_vertically = true },
+    { .is_rotated = true, .is_flipped_horizontally = false, .is_flipped_vertically = false },
+    { .is_rotated = true, .is_flipped_horizontally = true, .is_flipped_vertically = false },
+    { .is_rotated = true, .is_flipped_horizontally = false, .is_flipped_vertically = true },
+    { .is_rotated = true, .is_flipped_horizontally = true, .is_flipped_vertically = true }
+};
+
+// Sprites are normalized when they are loaded, others are converted on every use
+QImage toSpriteFormat(const QImage & _image)
+{
+    return _image.format() == g_sprite_image_format ? _image : _image.convertToFormat(g_sprite_image_format);
+}
+
+inline bool isTransparent(const uchar * _pixel)
+{
+    return _pixel[3] == 0;
+}
+
+// Makes the pixels of the color transparent black.
+// SSE2 processors compare four pixels at a time, the scalar loop handles the rest.
+void applyColorToAlphaRow(uchar * _row, int _width, QRgb _color)
+{
+    const uchar red = static_cast<uchar>(qRed(_color));
+    const uchar green = static_cast<uchar>(qGreen(_color));
+    const uchar blue = static_cast<uchar>(qBlue(_color));
+    int i = 0;
+#ifdef S2TP_SSE2
+    // The bytes of a pixel read as a little-endian integer, the alpha is not compared
+    const __m128i color_mask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i color = _mm_set1_epi32(red | (green << 8) | (blue << 16));
+    for(; i + 4 <= _width; i += 4)
+    {
+        __m128i * pixels = reinterpret_cast<__m128i *>(_row + i * 4);
+        const __m128i source = _mm_loadu_si128(pixels);
+        const __m128i is_color = _mm_cmpeq_epi32(_mm_and_si128(source, color_mask), color);
+        _mm_storeu_si128(pixels, _mm_andnot_si128(is_color, source));
+    }
+#endif
+    for(; i < _width; ++i)
+    {
+        uchar * pixel = _row + i * 4;
+        const uchar mask = static_cast<uchar>(-static_cast<int>((pixel[0] != red) | (pixel[1] != green) | (pixel[2] != blue)));
+        for(int c = 0; c < 4; ++c)
+            pixel[c] &= mask;
+    }
+}
+
+// Multiplies the colors of the pixels by their alpha, rounding as qPremultiply does.
+// SSE2 processors take four pixels at a time, the scalar loop handles the rest.
+void premultiplyRow(uchar * _row, int _width)
+{
+    int i = 0;
+#ifdef S2TP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    // The alpha lanes of the 16-bit halves keep their values
+    const __m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const auto premultiply = [&](__m128i __pixels) {
+        const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(__pixels, 0xFF), 0xFF);
+        const __m128i value = _mm_add_epi16(_mm_mullo_epi16(__pixels, alpha), half);
+        const __m128i result = _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+        return _mm_or_si128(_mm_andnot_si128(alpha_mask, result), _mm_and_si128(alpha_mask, __pixels));
+    };
+    for(; i + 4 <= _width; i += 4)
+    {
+        __m128i * pixels = reinterpret_cast<__m128i *>(_row + i * 4);
+        const __m128i source = _mm_loadu_si128(pixels);
+        _mm_storeu_si128(
+            pixels,
+            _mm_packus_epi16(
+                premultiply(_mm_unpacklo_epi8(source, zero)),
+                premultiply(_mm_unpackhi_epi8(source, zero))));
+    }
+#endif
+    for(; i < _width; ++i)
+    {
+        uchar * pixel = _row + i * 4;
+        const uint alpha = pixel[3];
+        for(int c = 0; c < 3; ++c)
+        {
+            // Exact x / 255 for x up to 255 * 255
+            const uint value = pixel[c] * alpha + 128;
+            pixel[c] = static_cast<uchar>((value + (value >> 8)) >> 8);
+        }
+    }
+}
+
+// Hashes only select candidates, the pixels are compared to tell duplicates for sure
+bool isSameContent(const QImage & _image1, const QRect & _rect1, const QImage & _image2, const QRect & _rect2)
+{
+    if(_rect1.size() != _rect2.size())
+        return false;
+    const QImage image1 = toSpriteFormat(_image1);
+    const QImage image2 = toSpriteFormat(_image2);
+    const size_t row_size = static_cast<size_t>(_rect1.width()) * 4;
+    for(int y = 0; y < _rect1.height(); ++y)
+    {
+        if(std::memcmp(
+            image1.constScanLine(_rect1.y() + y) + _rect1.x() * 4,
+            image2.constScanLine(_rect2.y() + y) + _rect2.x() * 4,
+            row_size) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copies the region turned the same way Pack::unpackFrame turns frames
+QImage orientSprite(const QImage & _image, const QRect & _rect, const SpriteOrientation & _orientation)
+{
+    QImage image = _image.copy(_rect);
+    if(_orientation.is_rotated)
+    {
+        QTransform rotation;
+        rotation.rotate(-90);
+        image = image.transformed(rotation);
+    }
+    if(_orientation.is_flipped_horizontally || _orientation.is_flipped_vertically)
+        image = image.mirrored(_orientation.is_flipped_horizontally, _orientation.is_flipped_vertically);
+    return toSpriteFormat(image);
+}
+
+// The least hash of all orientations, so that every orientation of the content gets the same one
+size_t hashCanonicalSprite(const QImage & _image, const QRect & _rect)
+{
+    size_t hash = hashSprite(_image, _rect);
+    for(const SpriteOrientation & orientation : g_orientations)
+    {
+        if(!orientation.is_rotated && !orientation.is_flipped_horizontally && !orientation.is_flipped_vertically)
+            continue;
+        const QImage image = orientSprite(_image, _rect, orientation);
+        hash = std::min(hash, hashSprite(image, image.rect()));
+    }
+    return hash;
+}
+
+// Finds the orientation that turns the original into the sprite
+std::optional<SpriteOrientation> matchOrientation(
+    const QImage & _image,
+    const QRect & _rect,
+    const QImage & _original_image,
+    const QRect & _original_rect,
+    bool _allow_transforms)
+{
+    if(isSameContent(_image, _rect, _original_image, _original_rect))
+        return SpriteOrientation { };
+    if(!_allow_transforms)
+        return std::nullopt;
+    for(const SpriteOrientation & orientation : g_orientations)
+    {
+        if(!orientation.is_rotated && !orientation.is_flipped_horizontally && !orientation.is_flipped_vertically)
+            continue;
+        const QSize size = orientation.is_rotated ? _original_rect.size().transposed() : _original_rect.size();
+        if(size != _rect.size())
+            continue;
+        const QImage image = orientSprite(_original_image, _original_rect, orientation);
+        if(isSameContent(_image, _rect, image, image.rect()))
+            return orientation;
+    }
+    return std::nullopt;
+}
+
+// Runs the function for each sprite on the global thread pool. The batches are small enough
+// for the calling thread to report the progress and to notice the cancellation in time.
+bool forEachSprite(
+    qsizetype _count,
+    const AtlasPackerContext & _context,
+    const std::function<void(qsizetype)> & _function,
+    const std::function<void(qsizetype)> & _on_progress)
+{
+    const qsizetype batch_size = std::max(1, QThread::idealThreadCount()) * g_sprites_per_thread_batch;
+    QList<qsizetype> batch;
+    for(qsizetype start = 0; start < _count; start += batch_size)
+    {
+        if(_context.isCanceled())
+            return false;
+        if(_on_progress)
+            _on_progress(start);
+        batch.resize(std::min(batch_size, _count - start));
+        std::iota(batch.begin(), batch.end(), start);
+        QtConcurrent::blockingMap(batch, [&_function](qsizetype __index) { _function(__index); });
+    }
+    return !_context.isCanceled();
+}
+
+// Extends the sprite with transparent pixels to whole multiples of the lattice on the right and bottom
+QImage padSprite(const QImage & _image, int _lattice)
+{
+    if(_lattice <= 1 || (_image.width() % _lattice == 0 && _image.height() % _lattice == 0))
+        return _image;
+    const QImage image = toSpriteFormat(_image);
+    QImage padded(alignSpriteSize(image.size(), _lattice), g_sprite_image_format);
+    padded.fill(Qt::transparent);
+    const size_t row_size = static_cast<size_t>(image.width()) * 4;
+    for(int y = 0; y < image.height(); ++y)
+        std::memcpy(padded.scanLine(y), image.constScanLine(y), row_size);
+    return padded;
+}
+
+// Grows the rect outwards to the lattice, the padded sprite always has room for it
+QRect alignSpriteRect(const QRect & _rect, int _lattice)
+{
+    if(_lattice <= 1 || _rect.isEmpty())
+        return _rect;
+    const int left = _rect.x() / _lattice * _lattice;
+    const int top = _rect.y() / _lattice * _lattice;
+    const QSize size = alignSpriteSize(QSize(_rect.right() + 1 - left, _rect.bottom() + 1 - top), _lattice);
+    return QRect(QPoint(left, top), size);
+}
+
+} // namespace
+
+void orientFrame(Frame & _frame, const SpriteOrientation & _orientation)
+{
+    // The sprite is the orientation applied to the frame's own restoring transform. A counterclockwise turn
+    // swaps the mirrors it follows, and two turns are the same as mirroring in both directions.
+    bool is_flipped_horizontally = _frame.is_flipped_horizontally;
+    bool is_flipped_vertically = _frame.is_flipped_vertically;
+    bool is_rotated = _frame.is_rotated;
+    if(_orientation.is_rotated)
+    {
+        std::swap(is_flipped_horizontally, is_flipped_vertically);
+        if(is_rotated)
+        {
+            is_flipped_horizontally = !is_flipped_horizontally;
+            is_flipped_vertically = !is_flipped_vertically;
+        }
+        is_rotated = !is_rotated;
+    }
+    _frame.is_rotated = is_rotated;
+    _frame.is_flipped_horizontally = is_flipped_horizontally != _orientation.is_flipped_horizontally;
+    _frame.is_flipped_vertically = is_flipped_vertically != _orientation.is_flipped_vertically;
+}
+
+QSize alignSpriteSize(const QSize & _size, int _block_size)
+{
+    if(_block_size <= 1)
+        return _size;
+    return QSize(
+        (_size.width() + _block_size - 1) / _block_size * _block_size,
+        (_size.height() + _block_size - 1) / _block_size * _block_size);
+}
+
+QSize alignAtlasSize(const QSize & _size, int _block_size)
+{
+    if(_block_size <= 1)
+        return _size;
+    return QSize(_size.width() / _block_size * _block_size, _size.height() / _block_size * _block_size);
+}
+
+QImage normalizeSpriteImage(const QImage & _image)
+{
+    return toSpriteFormat(_image);
+}
+
+QImage applyColorToAlpha(const QImage & _image, QRgb _color)
+{
+    QImage image = toSpriteFormat(_image);
+    for(int y = 0; y < image.height(); ++y)
+        applyColorToAlphaRow(image.scanLine(y), image.width(), _color);
+    return image;
+}
+
+QRect cropSprite(const QImage & _image, const AtlasPackerContext * _context)
+{
+    const QImage image = toSpriteFormat(_image);
+    const int width = image.width();
+    const int height = image.height();
+    const auto isRowTransparent = [&image, width](int __y) {
+        const uchar * line = image.constScanLine(__y);
+        for(int x = 0; x < width; ++x)
+        {
+            if(!isTransparent(line + x * 4))
+                return false;
+        }
+        return true;
+    };
+
+    int top = 0;
+    while(top < height && isRowTransparent(top))
+    {
+        if(_context && _context->isCanceled())
+            return QRect();
+        ++top;
+    }
+    // A fully transparent sprite keeps a single pixel, so that it still has a place in the atlas
+    if(top == height)
+        return width > 0 && height > 0 ? QRect(0, 0, 1, 1) : QRect();
+    int bottom = height - 1;
+    while(isRowTransparent(bottom))
+        --bottom;
+
+    // Each row only has to be scanned up to the leftmost and from the rightmost opaque pixel found so far
+    int left = width - 1;
+    int right = 0;
+    for(int y = top; y <= bottom; ++y)
+    {
+        if(_context && _context->isCanceled())
+            return QRect();
+        const uchar * line = image.constScanLine(y);
+        for(int x = 0; x < left; ++x)
+        {
+            if(!isTransparent(line + x * 4))
+            {
+                left = x;
+                break;
+            }
+        }
+        for(int x = width - 1; x > right; --x)
+        {
+            if(!isTransparent(line + x * 4))
+            {
+                right = x;
+                break;
+            }
+        }
+    }
+    return QRect(left, top, right - left + 1, bottom - top + 1);
+}
+
+size_t hashSprite(const QImage & _image, const QRect & _rect)
+{
+    // qHashBits uses the hardware accelerated hash of the platform, rows are chained through the seed.
+    // The size is hashed as well, regions of different shapes may share the same bytes.
+    const QImage image = toSpriteFormat(_image);
+    const size_t row_size = static_cast<size_t>(_rect.width()) * 4;
+    size_t hash = qHashMulti(0, _rect.width(), _rect.height());
+    for(int y = _rect.top(); y <= _rect.bottom(); ++y)
+        hash = qHashBits(image.constScanLine(y) + _rect.x() * 4, row_size, hash);
+    return hash;
+}
+
+QImage renderSprites(const QList<PlacedSprite> & _sprites, const AtlasPackerContext * _context, bool _premultiply_alpha)
+{
+    int max_x = 0;
+    int max_y = 0;
+    for(const PlacedSprite & sprite : _sprites)
+    {
+        int x = sprite.frame.texture_rect.x() + sprite.frame.texture_rect.width();
+        int y = sprite.frame.texture_rect.y() + sprite.frame.texture_rect.height();
+        if(x > max_x) max_x = x;
+        if(y > max_y) max_y = y;
+    }
+    QImage image(max_x, max_y, g_sprite_image_format);
+    image.fill(Qt::transparent);
+
+    // Pixels are copied as they are, blending into the transparent atlas would only cost precision
+    for(const PlacedSprite & sprite : _sprites)
+    {
+        if(sprite.image == nullptr)
+            continue;
+        if(_context && _context->isCanceled())
+            return QImage();
+        const QImage source = toSpriteFormat(*sprite.image);
+        const QRect & texture_rect = sprite.frame.texture_rect;
+        const QRect & sprite_rect = sprite.frame.sprite_rect;
+        if(sprite.frame.is_rotated)
+        {
+            // The sprite is turned clockwise: the texture row i is the source column read upwards
+            // from the bottom of the cropped area, the texture column j is the source column sx + j
+            for(int i = 0; i < texture_rect.height(); ++i)
+            {
+                quint32 * target = reinterpret_cast<quint32 *>(image.scanLine(texture_rect.y() + i)) + texture_rect.x();
+                const int source_x = sprite_rect.x() + i;
+                for(int j = 0; j < texture_rect.width(); ++j)
+                {
+                    const int source_y = sprite_rect.y() + texture_rect.width() - 1 - j;
+                    target[j] = reinterpret_cast<const quint32 *>(source.constScanLine(source_y))[source_x];
+                }
+                if(_premultiply_alpha)
+                    premultiplyRow(reinterpret_cast<uchar *>(target), texture_rect.width());
+            }
+        }
+        else
+        {
+            const qsizetype row_size = static_cast<qsizetype>(texture_rect.width()) * 4;
+            for(int i = 0; i < texture_rect.height(); ++i)
+            {
+                uchar * target = image.scanLine(texture_rect.y() + i) + texture_rect.x() * 4;
+                std::memcpy(target, source.constScanLine(sprite_rect.y() + i) + sprite_rect.x() * 4, static_cast<size_t>(row_size));
+                if(_premultiply_alpha)
+                    premultiplyRow(target, texture_rect.width());
+            }
+        }
+    }
+    // The pixels are already premultiplied, only the format is changed
+    if(_premultiply_alpha)
+        image.reinterpretAsFormat(QImage::Format_RGBA8888_Premultiplied);
+    return image;
+}
+
+bool analyzeSprites(
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options,
+    AtlasPackerContext & _context,
+    PackStatistics & _statistics,
+    SpriteAnalysis & _analysis,
+    const std::function<void(PackPhase, qsizetype)> & _on_progress)
+{
+    const qsizetype count = _sprites.count();
+    _analysis.images.resize(count);
+    _analysis.rects.resize(count);
+    _analysis.originals.resize(count);
+    _analysis.orientations.fill(SpriteOrientation { }, count);
+    const auto reportProgress = [&_on_progress](PackPhase __phase) -> std::function<void(qsizetype)> {
+        if(!_on_progress)
+            return nullptr;
+        return [&_on_progress, __phase](qsizetype __done) { _on_progress(__phase, __done); };
+    };
+    {
+        PackPhaseTimer timer(_statistics.phase(PackPhase::Crop));
+        if(_options.crop || _options.color_to_alpha || _options.scale_lattice > 1)
+        {
+            // The color is applied first, so that the keyed background is cropped too
+            const bool is_done = forEachSprite(
+                count,
+                _context,
+                [&](qsizetype __index) {
+                    QImage & image = _analysis.images[__index];
+                    image = _options.color_to_alpha
+                        ? applyColorToAlpha(_sprites[__index].image, *_options.color_to_alpha)
+                        : _sprites[__index].image;
+                    image = padSprite(image, _options.scale_lattice);
+                    _analysis.rects[__index] = _options.crop
+                        ? alignSpriteRect(cropSprite(image, &_context), _options.scale_lattice)
+                        : image.rect();
+                },
+                reportProgress(PackPhase::Crop));
+            if(!is_done)
+                return false;
+        }
+        else
+        {
+            for(qsizetype i = 0; i < count; ++i)
+            {
+                _analysis.images[i] = _sprites[i].image;
+                _analysis.rects[i] = _sprites[i].image.rect();
+            }
+        }
+    }
+    {
+        PackPhaseTimer timer(_statistics.phase(PackPhase::Hash));
+        std::iota(_analysis.originals.begin(), _analysis.originals.end(), 0);
+        if(!_options.detect_duplicates)
+            return true;
+        // Only the visible pixels are hashed, sprites that differ in transparent padding share the texture.
+        // Mirrored and rotated copies get the same hash when they are looked for.
+        const bool allow_transforms = _options.detect_transformed_duplicates;
+        QList<size_t> hashes(count);
+        const bool is_done = forEachSprite(
+            count,
+            _context,
+            [&](qsizetype __index) {
+                const QImage & image = _analysis.images[__index];
+                const QRect & rect = _analysis.rects[__index];
+                hashes[__index] = allow_transforms ? hashCanonicalSprite(image, rect) : hashSprite(image, rect);
+            },
+            reportProgress(PackPhase::Hash));
+        if(!is_done)
+            return false;
+        QMultiHash<size_t, qsizetype> first_occurrences;
+        first_occurrences.reserve(count);
+        for(qsizetype i = 0; i < count; ++i)
+        {
+            const size_t hash = hashes[i];
+            for(auto it = first_occurrences.constFind(hash); it != first_occurrences.cend() && it.key() == hash; ++it)
+            {
+                const qsizetype original = it.value();
+                const std::optional<SpriteOrientation> orientation = matchOrientation(
+                    _analysis.images[i],
+                    _analysis.rects[i],
+                    _analysis.images[original],
+                    _analysis.rects[original],
+                    allow_transforms);
+                if(orientation)
+                {
+                    _analysis.originals[i] = original;
+                    _analysis.orientations[i] = *orientation;
+                    break;
+                }
+            }
+            if(_analysis.originals[i] == i)
+                first_occurrences.insert(hash, i);
+        }
+    }
+    return true;
+}
+
+QList<UniqueSprite> collectUniqueSprites(
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options,
+    AtlasPackerContext & _context,
+    PackStatistics & _statistics)
+{
+    SpriteAnalysis analysis;
+    if(!analyzeSprites(_sprites, _options, _context, _statistics, analysis))
+        return {};
+    QList<UniqueSprite> unique_sprites;
+    QHash<qsizetype, qsizetype> unique_indices;
+    for(qsizetype i = 0; i < _sprites.count(); ++i)
+    {
+        const qsizetype original = analysis.originals[i];
+        if(original != i)
+        {
+            unique_sprites[unique_indices[original]].duplicates.append(i);
+            continue;
+        }
+        unique_indices.insert(i, unique_sprites.count());
+        unique_sprites.append({
+            .index = i,
+            .rect = analysis.rects[i],
+            .duplicates = {}
+        });
+    }
+    return unique_sprites;
+}
@@ -0,0 +1,100 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Packers/AtlasPacker.h>
+#include <LibSol2dTexturePacker/Frame.h>
+#include <QImage>
+#include <QList>
+#include <functional>
+
+struct S2TP_EXPORT PlacedSprite
+{
+    const QImage * image;
+    Frame frame;
+};
+
+// The format every sprite is kept in after loading: four bytes per pixel, alpha in the last byte
+constexpr QImage::Format g_sprite_image_format = QImage::Format_RGBA8888;
+
+// Rounds the size of a sprite up and the size of an atlas down to whole blocks
+S2TP_EXPORT QSize alignSpriteSize(const QSize & _size, int _block_size);
+S2TP_EXPORT QSize alignAtlasSize(const QSize & _size, int _block_size);
+
+// Returns the image in the sprite format, without a copy when it is already there
+S2TP_EXPORT QImage normalizeSpriteImage(const QImage & _image);
+// Returns the image in the sprite format with the pixels of the color made transparent black
+S2TP_EXPORT QImage applyColorToAlpha(const QImage & _image, QRgb _color);
+// The functions below take sprites in any format, but only the sprite format is handled without a conversion.
+// Both functions poll the context, if any, and return a null result once the job has been canceled
+S2TP_EXPORT QRect cropSprite(const QImage & _image, const AtlasPackerContext * _context = nullptr);
+// Hashes the pixels of the region, equal hashes do not guarantee equal content
+S2TP_EXPORT size_t hashSprite(const QImage & _image, const QRect & _rect);
+S2TP_EXPORT QImage renderSprites(
+    const QList<PlacedSprite> & _sprites,
+    const AtlasPackerContext * _context = nullptr,
+    bool _premultiply_alpha = false);
+
+// How a duplicate is made from its original: turned counterclockwise, then mirrored, the way frames are restored
+struct S2TP_EXPORT SpriteOrientation
+{
+    bool is_rotated = false;
+    bool is_flipped_horizontally = false;
+    bool is_flipped_vertically = false;
+};
+
+// Turns the frame placed for the original into the frame of its duplicate with the orientation
+S2TP_EXPORT void orientFrame(Frame & _frame, const SpriteOrientation & _orientation);
+
+// The visible region of every sprite, the index of the first sprite with the same visible content,
+// or the sprite's own index, and the orientation of the sprite relative to that first sprite.
+// The images are the sprites with the color to alpha applied, the atlases are rendered from them.
+struct S2TP_EXPORT SpriteAnalysis
+{
+    QList<QImage> images;
+    QList<QRect> rects;
+    QList<qsizetype> originals;
+    QList<SpriteOrientation> orientations;
+};
+
+// Crops sprites and detects duplicates as the options require, both passes run on the global thread pool.
+// The callback is called on the calling thread with the number of sprites done in the phase.
+// Returns false once the job has been canceled.
+S2TP_EXPORT bool analyzeSprites(
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options,
+    AtlasPackerContext & _context,
+    PackStatistics & _statistics,
+    SpriteAnalysis & _analysis,
+    const std::function<void(PackPhase, qsizetype)> & _on_progress = nullptr);
+
+// A sprite whose content does not repeat an earlier sprite, with the sprites that repeat it
+struct S2TP_EXPORT UniqueSprite
+{
+    qsizetype index;
+    QRect rect;
+    QList<qsizetype> duplicates;
+};
+
+// Detects duplicates and crops sprites as the options require. Returns an empty list once the job has been canceled.
+S2TP_EXPORT QList<UniqueSprite> collectUniqueSprites(
+    const QList<Sprite> & _sprites,
+    const AtlasPackerOptions & _options,
+    AtlasPackerContext & _context,
+    PackStatistics & _statistics);
@@ -0,0 +1,507 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/TextureCompressor.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Exception.h>
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr int g_block_pixel_count = g_texture_compression_block_size * g_texture_compression_block_size;
+// Pixels below this alpha are transparent in BC1
+constexpr int g_bc1_alpha_threshold = 128;
+constexpr int g_power_iteration_count = 4;
+
+// DDS, see https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+constexpr quint32 g_dds_magic = 0x20534444; // "DDS "
+constexpr quint32 g_dds_header_size = 124;
+constexpr quint32 g_dds_pixel_format_size = 32;
+constexpr quint32 g_dds_flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000; // Caps, height, width, pixel format, linear size
+constexpr quint32 g_dds_pixel_format_fourcc = 0x4;
+constexpr quint32 g_dds_caps_texture = 0x1000;
+constexpr quint32 g_dds_fourcc_dxt1 = 0x31545844; // "DXT1"
+constexpr quint32 g_dds_fourcc_dxt5 = 0x35545844; // "DXT5"
+
+// KTX2, see https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+constexpr std::array<quint8, 12> g_ktx2_identifier =
+{
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+constexpr quint32 g_ktx2_level_index_offset = 80;
+constexpr quint32 g_ktx2_level_index_size = 24;
+constexpr quint32 g_vk_format_bc1_rgba_unorm_block = 133;
+constexpr quint32 g_vk_format_bc3_unorm_block = 137;
+// Khronos Data Format descriptor, see https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html
+constexpr quint16 g_dfd_version = 2;
+constexpr quint32 g_dfd_block_header_size = 24;
+constexpr quint32 g_dfd_sample_size = 16;
+constexpr quint8 g_dfd_model_bc1a = 128;
+constexpr quint8 g_dfd_model_bc3 = 130;
+constexpr quint8 g_dfd_primaries_bt709 = 1;
+constexpr quint8 g_dfd_transfer_linear = 1;
+constexpr quint8 g_dfd_flags_straight_alpha = 0;
+constexpr quint8 g_dfd_flags_alpha_premultiplied = 1;
+constexpr quint8 g_dfd_channel_bc1a_alpha_present = 1;
+constexpr quint8 g_dfd_channel_bc3_color = 0;
+constexpr quint8 g_dfd_channel_bc3_alpha = 15;
+
+const char * g_container_dds = "dds";
+const char * g_container_ktx2 = "ktx2";
+
+constexpr TextureCompression g_texture_compressions[] =
+{
+    TextureCompression::None,
+    TextureCompression::BC1,
+    TextureCompression::BC3
+};
+
+typedef std::array<std::array<int, 4>, g_block_pixel_count> Block;
+
+int blockBytes(TextureCompression _compression)
+{
+    return _compression == TextureCompression::BC1 ? 8 : 16;
+}
+
+void readBlock(const QImage & _image, int _block_x, int _block_y, Block & _block)
+{
+    for(int y = 0; y < g_texture_compression_block_size; ++y)
+    {
+        const int image_y = std::min(_block_y * g_texture_compression_block_size + y, _image.height() - 1);
+        const uchar * line = _image.constScanLine(image_y);
+        for(int x = 0; x < g_texture_compression_block_size; ++x)
+        {
+            const int image_x = std::min(_block_x * g_texture_compression_block_size + x, _image.width() - 1);
+            const uchar * pixel = line + image_x * 4;
+            std::copy(pixel, pixel + 4, _block[y * g_texture_compression_block_size + x].begin());
+        }
+    }
+}
+
+void writeLittleEndian(uchar * _target, quint64 _value, int _bytes)
+{
+    for(int i = 0; i < _bytes; ++i)
+        _target[i] = static_cast<uchar>(_value >> (i * 8));
+}
+
+quint16 packColor565(float _r, float _g, float _b)
+{
+    const auto quantize = [](float __value, int __max) {
+        return static_cast<quint16>(std::clamp(static_cast<int>(std::lround(__value * __max / 255.0f)), 0, __max));
+    };
+    return static_cast<quint16>((quantize(_r, 31) << 11) | (quantize(_g, 63) << 5) | quantize(_b, 31));
+}
+
+std::array<int, 3> unpackColor565(quint16 _color)
+{
+    const int r = (_color >> 11) & 31;
+    const int g = (_color >> 5) & 63;
+    const int b = _color & 31;
+    return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+}
+
+// Endpoints are the extremes of the pixels along the principal axis of their colors, which is found by
+// a few power iterations over the covariance matrix. Pixels outside the mask do not take part in the fit.
+// Writes the two endpoints and the 2 bit indices. In the three color mode masked out pixels get index 3.
+void encodeColorBlock(const Block & _block, const std::array<bool, g_block_pixel_count> & _mask, bool _three_color, uchar * _out)
+{
+    int count = 0;
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for(int i = 0; i < g_block_pixel_count; ++i)
+    {
+        if(!_mask[i])
+            continue;
+        ++count;
+        for(int c = 0; c < 3; ++c)
+            mean[c] += static_cast<float>(_block[i][c]);
+    }
+    if(count == 0)
+    {
+        // Equal endpoints select the three color mode, where index 3 is transparent black
+        writeLittleEndian(_out, 0, 4);
+        writeLittleEndian(_out + 4, _three_color ? 0xFFFFFFFFu : 0u, 4);
+        return;
+    }
+    for(float & value : mean)
+        value /= static_cast<float>(count);
+
+    float covariance[3][3] = {};
+    for(int i = 0; i < g_block_pixel_count; ++i)
+    {
+        if(!_mask[i])
+            continue;
+        for(int a = 0; a < 3; ++a)
+        {
+            for(int b = 0; b < 3; ++b)
+                covariance[a][b] += (_block[i][a] - mean[a]) * (_block[i][b] - mean[b]);
+        }
+    }
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for(int iteration = 0; iteration < g_power_iteration_count; ++iteration)
+    {
+        float next[3];
+        for(int a = 0; a < 3; ++a)
+            next[a] = covariance[a][0] * axis[0] + covariance[a][1] * axis[1] + covariance[a][2] * axis[2];
+        const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if(length < 1e-6f)
+            break;
+        for(int a = 0; a < 3; ++a)
+            axis[a] = next[a] / length;
+    }
+    float min_projection = std::numeric_limits<float>::max();
+    float max_projection = std::numeric_limits<float>::lowest();
+    for(int i = 0; i < g_block_pixel_count; ++i)
+    {
+        if(!_mask[i])
+            continue;
+        float projection = 0.0f;
+        for(int c = 0; c < 3; ++c)
+            projection += (_block[i][c] - mean[c]) * axis[c];
+        min_projection = std::min(min_projection, projection);
+        max_projection = std::max(max_projection, projection);
+    }
+    // The interpolated colors cover the range better when the endpoints are moved slightly inwards
+    const float inset = (max_projection - min_projection) / 16.0f;
+    min_projection += inset;
+    max_projection -= inset;
+    quint16 color0 = packColor565(
+        mean[0] + axis[0] * max_projection,
+        mean[1] + axis[1] * max_projection,
+        mean[2] + axis[2] * max_projection);
+    quint16 color1 = packColor565(
+        mean[0] + axis[0] * min_projection,
+        mean[1] + axis[1] * min_projection,
+        mean[2] + axis[2] * min_projection);
+    // The order of the endpoints selects the mode: the four color mode needs the first one to be greater
+    if(_three_color ? color0 > color1 : color0 < color1)
+        std::swap(color0, color1);
+
+    std::array<std::array<int, 3>, 4> palette;
+    palette[0] = unpackColor565(color0);
+    palette[1] = unpackColor565(color1);
+    int palette_size = 4;
+    if(color0 > color1)
+    {
+        for(int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+    else
+    {
+        for(int c = 0; c < 3; ++c)
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+        palette_size = 3;
+    }
+
+    quint32 indices = 0;
+    for(int i = 0; i < g_block_pixel_count; ++i)
+    {
+        quint32 index = 3;
+        if(_mask[i] || !_three_color)
+        {
+            int best_distance = std::numeric_limits<int>::max();
+            for(int p = 0; p < palette_size; ++p)
+            {
+                int distance = 0;
+                for(int c = 0; c < 3; ++c)
+                    distance += (_block[i][c] - palette[p][c]) * (_block[i][c] - palette[p][c]);
+                if(distance < best_distance)
+                {
+                    best_distance = distance;
+                    index = static_cast<quint32>(p);
+                }
+            }
+        }
+        indices |= index << (i * 2);
+    }
+    writeLittleEndian(_out, color0, 2);
+    writeLittleEndian(_out + 2, color1, 2);
+    writeLittleEndian(_out + 4, indices, 4);
+}
+
+// Eight interpolated levels between the least and the greatest alpha of the block
+void encodeAlphaBlock(const Block & _block, uchar * _out)
+{
+    int alpha0 = 0;
+    int alpha1 = 255;
+    for(const std::array<int, 4> & pixel : _block)
+    {
+        alpha0 = std::max(alpha0, pixel[3]);
+        alpha1 = std::min(alpha1, pixel[3]);
+    }
+    quint64 indices = 0;
+    if(alpha0 > alpha1)
+    {
+        std::array<int, 8> levels;
+        levels[0] = alpha0;
+        levels[1] = alpha1;
+        for(int i = 1; i < 7; ++i)
+            levels[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        for(int i = 0; i < g_block_pixel_count; ++i)
+        {
+            quint64 best_index = 0;
+            int best_distance = std::numeric_limits<int>::max();
+            for(int level = 0; level < 8; ++level)
+            {
+                const int distance = std::abs(_block[i][3] - levels[level]);
+                if(distance < best_distance)
+                {
+                    best_distance = distance;
+                    best_index = static_cast<quint64>(level);
+                }
+            }
+            indices |= best_index << (i * 3);
+        }
+    }
+    _out[0] = static_cast<uchar>(alpha0);
+    _out[1] = static_cast<uchar>(alpha1);
+    writeLittleEndian(_out + 2, indices, 6);
+}
+
+void encodeBlock(const Block & _block, TextureCompression _compression, uchar * _out)
+{
+    std::array<bool, g_block_pixel_count> mask;
+    if(_compression == TextureCompression::BC1)
+    {
+        bool has_transparency = false;
+        for(int i = 0; i < g_block_pixel_count; ++i)
+        {
+            mask[i] = _block[i][3] >= g_bc1_alpha_threshold;
+            has_transparency = has_transparency || !mask[i];
+        }
+        encodeColorBlock(_block, mask, has_transparency, _out);
+    }
+    else
+    {
+        // The color of invisible pixels does not matter
+        for(int i = 0; i < g_block_pixel_count; ++i)
+            mask[i] = _block[i][3] > 0;
+        encodeAlphaBlock(_block, _out);
+        encodeColorBlock(_block, mask, false, _out + 8);
+    }
+}
+
+class LittleEndianWriter final
+{
+public:
+    explicit LittleEndianWriter(QIODevice * _device) :
+        m_stream(_device)
+    {
+        m_stream.setByteOrder(QDataStream::LittleEndian);
+    }
+
+    template<typename Int>
+    LittleEndianWriter & operator << (Int _value)
+    {
+        m_stream << _value;
+        return *this;
+    }
+
+    void writeBytes(const QByteArray & _bytes)
+    {
+        m_stream.writeRawData(_bytes.constData(), static_cast<int>(_bytes.size()));
+    }
+
+    void writeZeros(qsizetype _count)
+    {
+        writeBytes(QByteArray(_count, '\0'));
+    }
+
+    bool isOk() const
+    {
+        return m_stream.status() == QDataStream::Ok;
+    }
+
+private:
+    QDataStream m_stream;
+};
+
+void writeDds(LittleEndianWriter & _writer, const QImage & _image, TextureCompression _compression, const QByteArray & _data)
+{
+    _writer << g_dds_magic << g_dds_header_size << g_dds_flags
+        << static_cast<quint32>(_image.height())
+        << static_cast<quint32>(_image.width())
+        << static_cast<quint32>(_data.size())
+        << quint32(0)  // Depth
+        << quint32(0); // Mipmap count
+    _writer.writeZeros(11 * sizeof(quint32));
+    _writer << g_dds_pixel_format_size << g_dds_pixel_format_fourcc
+        << (_compression == TextureCompression::BC1 ? g_dds_fourcc_dxt1 : g_dds_fourcc_dxt5);
+    _writer.writeZeros(5 * sizeof(quint32)); // Bit count and masks
+    _writer << g_dds_caps_texture;
+    _writer.writeZeros(4 * sizeof(quint32)); // Other caps and the reserved field
+    _writer.writeBytes(_data);
+}
+
+void writeKtx2(
+    LittleEndianWriter & _writer,
+    const QImage & _image,
+    TextureCompression _compression,
+    bool _is_alpha_premultiplied,
+    const QByteArray & _data)
+{
+    const bool is_bc1 = _compression == TextureCompression::BC1;
+    const quint32 sample_count = is_bc1 ? 1 : 2;
+    const quint32 dfd_offset = g_ktx2_level_index_offset + g_ktx2_level_index_size;
+    const quint32 dfd_size = sizeof(quint32) + g_dfd_block_header_size + sample_count * g_dfd_sample_size;
+    // The level data is aligned to the block size, which is a multiple of 4
+    const quint64 alignment = static_cast<quint64>(blockBytes(_compression));
+    const quint64 data_offset = (dfd_offset + dfd_size + alignment - 1) / alignment * alignment;
+
+    for(quint8 byte : g_ktx2_identifier)
+        _writer << byte;
+    _writer << (is_bc1 ? g_vk_format_bc1_rgba_unorm_block : g_vk_format_bc3_unorm_block)
+        << quint32(1) // Type size
+        << static_cast<quint32>(_image.width())
+        << static_cast<quint32>(_image.height())
+        << quint32(0) // Depth
+        << quint32(0) // Layer count
+        << quint32(1) // Face count
+        << quint32(1) // Level count
+        << quint32(0); // Supercompression scheme
+    _writer << dfd_offset << dfd_size
+        << quint32(0) << quint32(0)  // Key/value data
+        << quint64(0) << quint64(0); // Supercompression global data
+    _writer << data_offset << static_cast<quint64>(_data.size()) << static_cast<quint64>(_data.size());
+
+    _writer << dfd_size
+        << quint32(0) // Vendor and descriptor type
+        << g_dfd_version
+        << static_cast<quint16>(g_dfd_block_header_size + sample_count * g_dfd_sample_size)
+        << (is_bc1 ? g_dfd_model_bc1a : g_dfd_model_bc3)
+        << g_dfd_primaries_bt709
+        << g_dfd_transfer_linear
+        << (_is_alpha_premultiplied ? g_dfd_flags_alpha_premultiplied : g_dfd_flags_straight_alpha)
+        << quint8(g_texture_compression_block_size - 1)
+        << quint8(g_texture_compression_block_size - 1)
+        << quint8(0) << quint8(0)
+        << static_cast<quint8>(blockBytes(_compression));
+    _writer.writeZeros(7); // Bytes of the other planes
+    const auto writeSample = [&_writer](quint16 __bit_offset, quint8 __channel) {
+        _writer << __bit_offset
+            << quint8(63) // Bit length minus one
+            << __channel
+            << quint32(0) // Sample position
+            << quint32(0) // Lower
+            << quint32(0xFFFFFFFF); // Upper
+    };
+    if(is_bc1)
+    {
+        writeSample(0, g_dfd_channel_bc1a_alpha_present);
+    }
+    else
+    {
+        writeSample(0, g_dfd_channel_bc3_alpha);
+        writeSample(64, g_dfd_channel_bc3_color);
+    }
+    _writer.writeZeros(static_cast<qsizetype>(data_offset - dfd_offset - dfd_size));
+    _writer.writeBytes(_data);
+}
+
+} // namespace
+
+QString textureCompressionName(TextureCompression _compression)
+{
+    switch(_compression)
+    {
+    case TextureCompression::None:
+        return "none";
+    case TextureCompression::BC1:
+        return "bc1";
+    case TextureCompression::BC3:
+        return "bc3";
+    default:
+        return QString();
+    }
+}
+
+std::optional<TextureCompression> parseTextureCompression(const QString & _name)
+{
+    for(TextureCompression compression : g_texture_compressions)
+    {
+        if(_name.compare(textureCompressionName(compression), Qt::CaseInsensitive) == 0)
+            return compression;
+    }
+    return std::nullopt;
+}
+
+bool isCompressedTextureContainer(const QString & _image_format)
+{
+    return _image_format.compare(g_container_dds, Qt::CaseInsensitive) == 0 ||
+        _image_format.compare(g_container_ktx2, Qt::CaseInsensitive) == 0;
+}
+
+QByteArray compressTexture(const QImage & _image, TextureCompression _compression)
+{
+    if(_compression == TextureCompression::None || _image.isNull())
+        return QByteArray();
+    const QImage image = normalizeSpriteImage(_image);
+    const int block_columns = (image.width() + g_texture_compression_block_size - 1) / g_texture_compression_block_size;
+    const int block_rows = (image.height() + g_texture_compression_block_size - 1) / g_texture_compression_block_size;
+    const qsizetype row_bytes = static_cast<qsizetype>(block_columns) * blockBytes(_compression);
+    QByteArray data(row_bytes * block_rows, '\0');
+    // Taken before the threads start, so that none of them detaches the array
+    uchar * out = reinterpret_cast<uchar *>(data.data());
+    QList<int> rows(block_rows);
+    std::iota(rows.begin(), rows.end(), 0);
+    QtConcurrent::blockingMap(rows, [&](int __row) {
+        Block block;
+        uchar * row_out = out + __row * row_bytes;
+        for(int column = 0; column < block_columns; ++column)
+        {
+            readBlock(image, column, __row, block);
+            encodeBlock(block, _compression, row_out + column * blockBytes(_compression));
+        }
+    });
+    return data;
+}
+
+void saveCompressedTexture(
+    const QImage & _image,
+    TextureCompression _compression,
+    bool _is_alpha_premultiplied,
+    const QString & _image_format,
+    const QString & _file)
+{
+    if(_compression == TextureCompression::None || !isCompressedTextureContainer(_image_format))
+    {
+        throw InvalidOperationExeption(
+            QObject::tr("Compressed textures are written to %1 or %2 files only").arg(g_container_dds, g_container_ktx2));
+    }
+    const QByteArray data = compressTexture(_image, _compression);
+    QFile file(_file);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw FileOpenException(_file, FileOpenException::Write);
+    LittleEndianWriter writer(&file);
+    if(_image_format.compare(g_container_dds, Qt::CaseInsensitive) == 0)
+        writeDds(writer, _image, _compression, data);
+    else
+        writeKtx2(writer, _image, _compression, _is_alpha_premultiplied, data);
+    if(!writer.isOk())
+        throw ImageSavingException(_file);
+}
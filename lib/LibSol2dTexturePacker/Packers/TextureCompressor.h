@@ -0,0 +1,52 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Def.h>
+#include <QImage>
+#include <QByteArray>
+#include <optional>
+
+enum class S2TP_EXPORT TextureCompression
+{
+    None,
+    // Opaque or one bit alpha, 4 bits per pixel
+    BC1,
+    // Interpolated alpha, 8 bits per pixel
+    BC3
+};
+
+// The side of the square pixel block the compressed formats encode at once
+constexpr int g_texture_compression_block_size = 4;
+
+S2TP_EXPORT QString textureCompressionName(TextureCompression _compression);
+S2TP_EXPORT std::optional<TextureCompression> parseTextureCompression(const QString & _name);
+// Tells whether the image file format is a container compressed textures are written to
+S2TP_EXPORT bool isCompressedTextureContainer(const QString & _image_format);
+
+// Encodes the blocks on the global thread pool. Blocks past the edges of the image repeat the edge pixels.
+S2TP_EXPORT QByteArray compressTexture(const QImage & _image, TextureCompression _compression);
+// Writes the compressed texture to a DDS or KTX2 file, the container is chosen by the image format.
+// KTX2 files tell whether the alpha is premultiplied, DDS headers of the DXT formats have no room for it.
+S2TP_EXPORT void saveCompressedTexture(
+    const QImage & _image,
+    TextureCompression _compression,
+    bool _is_alpha_premultiplied,
+    const QString & _image_format,
+    const QString & _file);
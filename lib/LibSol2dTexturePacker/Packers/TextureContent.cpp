@@ -0,0 +1,76 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/TextureContent.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <LibSol2dTexturePacker/Def.h>
+#ifdef S2TP_SSE2
+#   include <emmintrin.h>
+#endif
+
+TextureContent analyzeTextureContent(const QImage & _image)
+{
+    // Opaque pixels are the same premultiplied or not, so premultiplied atlases are read as they are
+    const QImage image = _image.format() == QImage::Format_RGBA8888_Premultiplied
+        ? _image
+        : normalizeSpriteImage(_image);
+    // The alpha of all pixels is reduced with AND and the differences between the color channels with OR.
+    // SSE2 processors take four pixels at a time, the rows are checked for an early exit.
+    uchar alpha = 0xFF;
+    uchar chroma = 0;
+    for(int y = 0; y < image.height(); ++y)
+    {
+        const uchar * line = image.constScanLine(y);
+        int x = 0;
+#ifdef S2TP_SSE2
+        // Pixels read as little-endian integers: the low bytes of the shifted XOR are red ^ green and green ^ blue
+        const __m128i chroma_mask = _mm_set1_epi32(0x0000FFFF);
+        __m128i alpha_accumulator = _mm_set1_epi32(-1);
+        __m128i chroma_accumulator = _mm_setzero_si128();
+        for(; x + 4 <= image.width(); x += 4)
+        {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x * 4));
+            alpha_accumulator = _mm_and_si128(alpha_accumulator, pixels);
+            chroma_accumulator = _mm_or_si128(
+                chroma_accumulator,
+                _mm_and_si128(_mm_xor_si128(pixels, _mm_srli_epi32(pixels, 8)), chroma_mask));
+        }
+        alpha_accumulator = _mm_and_si128(alpha_accumulator, _mm_shuffle_epi32(alpha_accumulator, _MM_SHUFFLE(1, 0, 3, 2)));
+        alpha_accumulator = _mm_and_si128(alpha_accumulator, _mm_shuffle_epi32(alpha_accumulator, _MM_SHUFFLE(2, 3, 0, 1)));
+        chroma_accumulator = _mm_or_si128(chroma_accumulator, _mm_shuffle_epi32(chroma_accumulator, _MM_SHUFFLE(1, 0, 3, 2)));
+        chroma_accumulator = _mm_or_si128(chroma_accumulator, _mm_shuffle_epi32(chroma_accumulator, _MM_SHUFFLE(2, 3, 0, 1)));
+        const quint32 alpha_bits = static_cast<quint32>(_mm_cvtsi128_si32(alpha_accumulator));
+        const quint32 chroma_bits = static_cast<quint32>(_mm_cvtsi128_si32(chroma_accumulator));
+        alpha &= static_cast<uchar>(alpha_bits >> 24);
+        chroma |= static_cast<uchar>(chroma_bits | (chroma_bits >> 8));
+#endif
+        for(; x < image.width(); ++x)
+        {
+            const uchar * pixel = line + x * 4;
+            alpha &= pixel[3];
+            chroma |= static_cast<uchar>((pixel[0] ^ pixel[1]) | (pixel[1] ^ pixel[2]));
+        }
+        if(alpha != 0xFF && chroma != 0)
+            break;
+    }
+    return TextureContent
+    {
+        .is_opaque = alpha == 0xFF,
+        .is_grayscale = chroma == 0
+    };
+}
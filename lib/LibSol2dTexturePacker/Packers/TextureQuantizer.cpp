@@ -0,0 +1,435 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/Packers/TextureQuantizer.h>
+#include <LibSol2dTexturePacker/Packers/SpriteProcessing.h>
+#include <QHash>
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace {
+
+constexpr TextureDithering g_texture_ditherings[] =
+{
+    TextureDithering::None,
+    TextureDithering::Ordered,
+    TextureDithering::FloydSteinberg
+};
+
+constexpr int g_bayer_matrix[4][4] =
+{
+    { 0, 8, 2, 10 },
+    { 12, 4, 14, 6 },
+    { 3, 11, 1, 9 },
+    { 15, 7, 13, 5 }
+};
+
+constexpr int g_color_channel_count = 3;
+constexpr int g_alpha_channel = 3;
+
+// Bits per channel in the order of the sprite format: red, green, blue and alpha. Zero drops the channel.
+struct ChannelDepths
+{
+    int bits[4];
+};
+
+ChannelDepths getChannelDepths(TexturePixelFormat _format)
+{
+    switch(_format)
+    {
+    case TexturePixelFormat::RGBA4444:
+        return { { 4, 4, 4, 4 } };
+    case TexturePixelFormat::RGB565:
+        return { { 5, 6, 5, 0 } };
+    case TexturePixelFormat::RGBA5551:
+        return { { 5, 5, 5, 1 } };
+    default:
+        return { { 8, 8, 8, 8 } };
+    }
+}
+
+// Rounded levels of every eight-bit value for each channel, widened back to eight bits the way GPUs do.
+// A channel of zero bits maps everything to 255, which drops the alpha of formats without one.
+struct QuantizationTables
+{
+    uchar levels[4][256];
+};
+
+QuantizationTables createQuantizationTables(const ChannelDepths & _depths)
+{
+    QuantizationTables tables;
+    for(int channel = 0; channel < 4; ++channel)
+    {
+        const int max_level = (1 << _depths.bits[channel]) - 1;
+        for(int value = 0; value < 256; ++value)
+        {
+            if(max_level == 0)
+            {
+                tables.levels[channel][value] = 255;
+                continue;
+            }
+            const int level = (value * max_level + 127) / 255;
+            tables.levels[channel][value] = static_cast<uchar>((level * 255 + max_level / 2) / max_level);
+        }
+    }
+    return tables;
+}
+
+// Each channel is quantized by a lookup in the table of its depth, so there is no division per pixel.
+// The lookups are gathers the compiler does not vectorize, and Floyd-Steinberg carries the error from pixel
+// to pixel, so every path here is a scalar loop.
+void quantizeRows(QImage & _image, const ChannelDepths & _depths, TextureDithering _dithering)
+{
+    const int width = _image.width();
+    const QuantizationTables tables = createQuantizationTables(_depths);
+    int max_levels[g_color_channel_count];
+    for(int channel = 0; channel < g_color_channel_count; ++channel)
+        max_levels[channel] = (1 << _depths.bits[channel]) - 1;
+    const uchar * alpha_levels = tables.levels[g_alpha_channel];
+
+    // Quantization errors in 1/16 of a level of the current and of the next row, with a pixel of margin each side
+    std::vector<int> errors;
+    std::vector<int> next_errors;
+    if(_dithering == TextureDithering::FloydSteinberg)
+    {
+        errors.assign(static_cast<size_t>(width + 2) * g_color_channel_count, 0);
+        next_errors.assign(errors.size(), 0);
+    }
+
+    for(int y = 0; y < _image.height(); ++y)
+    {
+        uchar * line = _image.scanLine(y);
+        switch(_dithering)
+        {
+        case TextureDithering::Ordered:
+        {
+            // Offsets from -1/2 to 1/2 of a level for the four columns of the pattern row
+            int offsets[4][g_color_channel_count];
+            for(int phase = 0; phase < 4; ++phase)
+            {
+                for(int channel = 0; channel < g_color_channel_count; ++channel)
+                    offsets[phase][channel] = (2 * g_bayer_matrix[y & 3][phase] - 15) * 255 / (32 * max_levels[channel]);
+            }
+            for(int x = 0; x < width; ++x)
+            {
+                uchar * pixel = line + x * 4;
+                for(int channel = 0; channel < g_color_channel_count; ++channel)
+                {
+                    const int value = std::clamp(pixel[channel] + offsets[x & 3][channel], 0, 255);
+                    pixel[channel] = tables.levels[channel][value];
+                }
+            }
+            break;
+        }
+        case TextureDithering::FloydSteinberg:
+        {
+            std::fill(next_errors.begin(), next_errors.end(), 0);
+            for(int x = 0; x < width; ++x)
+            {
+                uchar * pixel = line + x * 4;
+                int * error = errors.data() + (x + 1) * g_color_channel_count;
+                int * next_error = next_errors.data() + (x + 1) * g_color_channel_count;
+                for(int channel = 0; channel < g_color_channel_count; ++channel)
+                {
+                    const int value = std::clamp(pixel[channel] + ((error[channel] + 8) >> 4), 0, 255);
+                    const int quantized = tables.levels[channel][value];
+                    const int residual = value - quantized;
+                    pixel[channel] = static_cast<uchar>(quantized);
+                    error[channel + g_color_channel_count] += residual * 7;
+                    next_error[channel - g_color_channel_count] += residual * 3;
+                    next_error[channel] += residual * 5;
+                    next_error[channel + g_color_channel_count] += residual;
+                }
+            }
+            errors.swap(next_errors);
+            break;
+        }
+        default:
+            for(int x = 0; x < width * 4; x += 4)
+            {
+                for(int channel = 0; channel < g_color_channel_count; ++channel)
+                    line[x + channel] = tables.levels[channel][line[x + channel]];
+            }
+            break;
+        }
+        for(int x = g_alpha_channel; x < width * 4; x += 4)
+            line[x] = alpha_levels[line[x]];
+    }
+}
+
+QImage extractGrayscale(const QImage & _image, TexturePixelFormat _format)
+{
+    QImage result(_image.size(), QImage::Format_Grayscale8);
+    for(int y = 0; y < _image.height(); ++y)
+    {
+        const uchar * source = _image.constScanLine(y);
+        uchar * target = result.scanLine(y);
+        if(_format == TexturePixelFormat::A8)
+        {
+            for(int x = 0; x < _image.width(); ++x)
+                target[x] = source[x * 4 + g_alpha_channel];
+        }
+        else
+        {
+            // Rec. 601 luma in fixed point
+            for(int x = 0; x < _image.width(); ++x)
+            {
+                const uchar * pixel = source + x * 4;
+                target[x] = static_cast<uchar>((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29 + 128) >> 8);
+            }
+        }
+    }
+    return result;
+}
+
+constexpr int g_palette_size = 256;
+
+inline QRgb readColor(const uchar * _pixel)
+{
+    return qRgba(_pixel[0], _pixel[1], _pixel[2], _pixel[3]);
+}
+
+inline int colorChannel(QRgb _color, int _channel)
+{
+    switch(_channel)
+    {
+    case 0:
+        return qRed(_color);
+    case 1:
+        return qGreen(_color);
+    case 2:
+        return qBlue(_color);
+    default:
+        return qAlpha(_color);
+    }
+}
+
+// Collects the colors of the image, the pixels of a run are looked up once.
+// Returns nothing when there are more colors than a palette holds.
+std::optional<QHash<QRgb, int>> findExactPalette(const QImage & _image)
+{
+    QHash<QRgb, int> indices;
+    bool has_last = false;
+    QRgb last = 0;
+    for(int y = 0; y < _image.height(); ++y)
+    {
+        const uchar * line = _image.constScanLine(y);
+        for(int x = 0; x < _image.width(); ++x)
+        {
+            const QRgb color = readColor(line + x * 4);
+            if(has_last && color == last)
+                continue;
+            has_last = true;
+            last = color;
+            if(indices.contains(color))
+                continue;
+            if(indices.count() == g_palette_size)
+                return std::nullopt;
+            indices.insert(color, static_cast<int>(indices.count()));
+        }
+    }
+    return indices;
+}
+
+struct HistogramEntry
+{
+    QRgb color;
+    qsizetype count;
+};
+
+struct ColorBox
+{
+    qsizetype begin;
+    qsizetype end;
+    int channel;
+    int range;
+};
+
+ColorBox makeColorBox(const std::vector<HistogramEntry> & _entries, qsizetype _begin, qsizetype _end)
+{
+    ColorBox box { .begin = _begin, .end = _end, .channel = 0, .range = 0 };
+    for(int channel = 0; channel < 4; ++channel)
+    {
+        int min = 255;
+        int max = 0;
+        for(qsizetype i = _begin; i < _end; ++i)
+        {
+            const int value = colorChannel(_entries[i].color, channel);
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+        if(max - min > box.range)
+        {
+            box.channel = channel;
+            box.range = max - min;
+        }
+    }
+    return box;
+}
+
+// Median cut: the box with the widest channel is split at the median pixel of that channel
+// until there are as many boxes as palette entries. Each color takes the average of its box.
+QHash<QRgb, int> buildMedianCutPalette(const QImage & _image, QList<QRgb> & _table)
+{
+    QHash<QRgb, qsizetype> histogram;
+    for(int y = 0; y < _image.height(); ++y)
+    {
+        const uchar * line = _image.constScanLine(y);
+        for(int x = 0; x < _image.width(); ++x)
+            ++histogram[readColor(line + x * 4)];
+    }
+    std::vector<HistogramEntry> entries;
+    entries.reserve(static_cast<size_t>(histogram.count()));
+    for(auto it = histogram.cbegin(); it != histogram.cend(); ++it)
+        entries.push_back({ .color = it.key(), .count = it.value() });
+
+    std::vector<ColorBox> boxes;
+    boxes.push_back(makeColorBox(entries, 0, static_cast<qsizetype>(entries.size())));
+    while(boxes.size() < static_cast<size_t>(g_palette_size))
+    {
+        auto widest = std::max_element(boxes.begin(), boxes.end(), [](const ColorBox & __a, const ColorBox & __b) {
+            return __a.range < __b.range;
+        });
+        if(widest->range == 0)
+            break;
+        const ColorBox box = *widest;
+        std::sort(
+            entries.begin() + box.begin,
+            entries.begin() + box.end,
+            [&box](const HistogramEntry & __a, const HistogramEntry & __b) {
+                return colorChannel(__a.color, box.channel) < colorChannel(__b.color, box.channel);
+            });
+        qsizetype total = 0;
+        for(qsizetype i = box.begin; i < box.end; ++i)
+            total += entries[i].count;
+        // The box has two distinct values in the channel at least, so both halves get some colors
+        qsizetype split = box.begin + 1;
+        for(qsizetype accumulated = entries[box.begin].count; split < box.end - 1 && accumulated * 2 < total; ++split)
+            accumulated += entries[split].count;
+        *widest = makeColorBox(entries, box.begin, split);
+        boxes.push_back(makeColorBox(entries, split, box.end));
+    }
+
+    QHash<QRgb, int> indices;
+    indices.reserve(static_cast<qsizetype>(entries.size()));
+    _table.clear();
+    for(const ColorBox & box : boxes)
+    {
+        qint64 sums[4] = { 0, 0, 0, 0 };
+        qint64 count = 0;
+        for(qsizetype i = box.begin; i < box.end; ++i)
+        {
+            for(int channel = 0; channel < 4; ++channel)
+                sums[channel] += static_cast<qint64>(colorChannel(entries[i].color, channel)) * entries[i].count;
+            count += entries[i].count;
+            indices.insert(entries[i].color, static_cast<int>(_table.count()));
+        }
+        const auto average = [count](qint64 __sum) { return static_cast<int>((__sum + count / 2) / count); };
+        _table.append(qRgba(average(sums[0]), average(sums[1]), average(sums[2]), average(sums[3])));
+    }
+    return indices;
+}
+
+QImage makeIndexedImage(const QImage & _image)
+{
+    QList<QRgb> table;
+    QHash<QRgb, int> indices;
+    if(std::optional<QHash<QRgb, int>> exact_indices = findExactPalette(_image))
+    {
+        indices = std::move(*exact_indices);
+        table.resize(indices.count());
+        for(auto it = indices.cbegin(); it != indices.cend(); ++it)
+            table[it.value()] = it.key();
+    }
+    else
+    {
+        indices = buildMedianCutPalette(_image, table);
+    }
+    QImage result(_image.size(), QImage::Format_Indexed8);
+    result.setColorTable(table);
+    for(int y = 0; y < _image.height(); ++y)
+    {
+        const uchar * source = _image.constScanLine(y);
+        uchar * target = result.scanLine(y);
+        QRgb last = 0;
+        int last_index = -1;
+        for(int x = 0; x < _image.width(); ++x)
+        {
+            const QRgb color = readColor(source + x * 4);
+            if(last_index < 0 || color != last)
+            {
+                last = color;
+                last_index = indices.value(color);
+            }
+            target[x] = static_cast<uchar>(last_index);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+QString textureDitheringName(TextureDithering _dithering)
+{
+    switch(_dithering)
+    {
+    case TextureDithering::None:
+        return "none";
+    case TextureDithering::Ordered:
+        return "ordered";
+    case TextureDithering::FloydSteinberg:
+        return "floyd-steinberg";
+    default:
+        return QString();
+    }
+}
+
+std::optional<TextureDithering> parseTextureDithering(const QString & _name)
+{
+    for(TextureDithering dithering : g_texture_ditherings)
+    {
+        if(_name.compare(textureDitheringName(dithering), Qt::CaseInsensitive) == 0)
+            return dithering;
+    }
+    return std::nullopt;
+}
+
+QImage quantizeTexture(const QImage & _image, const TextureOptions & _options)
+{
+    switch(_options.pixel_format)
+    {
+    case TexturePixelFormat::RGBA8888:
+        return _image;
+    case TexturePixelFormat::RGB888:
+        return normalizeSpriteImage(_image).convertToFormat(QImage::Format_RGB888);
+    case TexturePixelFormat::Indexed8:
+        return makeIndexedImage(normalizeSpriteImage(_image));
+    case TexturePixelFormat::A8:
+    case TexturePixelFormat::L8:
+        return extractGrayscale(normalizeSpriteImage(_image), _options.pixel_format);
+    default:
+        break;
+    }
+    // Writing to the scan lines detaches the copy, the atlas itself keeps the full precision
+    QImage image = normalizeSpriteImage(_image);
+    quantizeRows(image, getChannelDepths(_options.pixel_format), _options.dithering);
+    if(_options.pixel_format == TexturePixelFormat::RGB565)
+        return image.convertToFormat(QImage::Format_RGB888);
+    return image;
+}
@@ -0,0 +1,51 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/TexturePixelFormat.h>
+#include <LibSol2dTexturePacker/Packers/TextureCompressor.h>
+#include <QImage>
+
+enum class S2TP_EXPORT TextureDithering
+{
+    None,
+    // A 4x4 Bayer pattern, stable between frames and cheap
+    Ordered,
+    // Error diffusion, smoother gradients at the cost of a noisier look
+    FloydSteinberg
+};
+
+struct S2TP_EXPORT TextureOptions
+{
+    TexturePixelFormat pixel_format = TexturePixelFormat::RGBA8888;
+    TextureDithering dithering = TextureDithering::None;
+    // Compressed textures are encoded after the quantization and need sprites aligned to the block size
+    TextureCompression compression = TextureCompression::None;
+    // Full precision atlases without transparent pixels are written as RGB888, or as L8 when they are gray
+    bool strip_opaque_alpha = false;
+};
+
+S2TP_EXPORT QString textureDitheringName(TextureDithering _dithering);
+S2TP_EXPORT std::optional<TextureDithering> parseTextureDithering(const QString & _name);
+
+// Reduces the atlas to the precision of the pixel format. The 16 bit formats stay four channel images with every
+// channel widened back to eight bits, so any image file format can hold them and the upload is lossless.
+// RGB565 loses the alpha channel, A8 and L8 become grayscale images. Alpha is never dithered,
+// the noise would show up as fringes around the sprites. Indexed8 becomes an indexed image, which is not dithered.
+S2TP_EXPORT QImage quantizeTexture(const QImage & _image, const TextureOptions & _options);
@@ -0,0 +1,70 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#include <LibSol2dTexturePacker/TexturePixelFormat.h>
+
+namespace {
+
+constexpr TexturePixelFormat g_texture_pixel_formats[] =
+{
+    TexturePixelFormat::RGBA8888,
+    TexturePixelFormat::RGB888,
+    TexturePixelFormat::RGBA4444,
+    TexturePixelFormat::RGB565,
+    TexturePixelFormat::RGBA5551,
+    TexturePixelFormat::A8,
+    TexturePixelFormat::L8,
+    TexturePixelFormat::Indexed8
+};
+
+} // namespace
+
+QString texturePixelFormatName(TexturePixelFormat _format)
+{
+    switch(_format)
+    {
+    case TexturePixelFormat::RGBA8888:
+        return "rgba8888";
+    case TexturePixelFormat::RGB888:
+        return "rgb888";
+    case TexturePixelFormat::RGBA4444:
+        return "rgba4444";
+    case TexturePixelFormat::RGB565:
+        return "rgb565";
+    case TexturePixelFormat::RGBA5551:
+        return "rgba5551";
+    case TexturePixelFormat::A8:
+        return "a8";
+    case TexturePixelFormat::L8:
+        return "l8";
+    case TexturePixelFormat::Indexed8:
+        return "indexed8";
+    default:
+        return QString();
+    }
+}
+
+std::optional<TexturePixelFormat> parseTexturePixelFormat(const QString & _name)
+{
+    for(TexturePixelFormat format : g_texture_pixel_formats)
+    {
+        if(_name.compare(texturePixelFormatName(format), Qt::CaseInsensitive) == 0)
+            return format;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,44 @@
+/**********************************************************************************************************
+ * Copyright © 2025 Sergey Smolyannikov aka brainstream                                                   *
+ *                                                                                                        *
+ * This file is part of the Sol2D Texture Packer.                                                         *
+ *                                                                                                        *
+ * Sol2D Texture Packer is free software: you can redistribute it and/or modify it under  the terms of    *
+ * the GNU General Public License as published by the Free Software Foundation, either version 3 of the   *
+ * License, or (at your option) any later version.                                                        *
+ *                                                                                                        *
+ * Sol2D Texture Packer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.             *
+ * See the GNU General Public License for more details.                                                   *
+ *                                                                                                        *
+ * You should have received a copy of the GNU General Public License along with MailUnit.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                                                            *
+ *                                                                                                        *
+ **********************************************************************************************************/
+
+#pragma once
+
+#include <LibSol2dTexturePacker/Def.h>
+#include <QString>
+#include <optional>
+
+// The pixel format the atlas texture is meant to be uploaded in. Textures are written with the precision
+// of the format, but in whatever image file format was chosen.
+enum class S2TP_EXPORT TexturePixelFormat
+{
+    RGBA8888,
+    // Full precision without alpha, for atlases with no transparent pixels
+    RGB888,
+    RGBA4444,
+    RGB565,
+    RGBA5551,
+    // Alpha only, written as a grayscale image
+    A8,
+    // Luminance only, written as a grayscale image
+    L8,
+    // Up to 256 colors with alpha, written as an indexed image. Images with more colors are reduced by median cut.
+    Indexed8
+};
+
+S2TP_EXPORT QString texturePixelFormatName(TexturePixelFormat _format);
+S2TP_EXPORT std::optional<TexturePixelFormat> parseTexturePixelFormat(const QString & _name);